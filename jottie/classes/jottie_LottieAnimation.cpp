@@ -32,17 +32,43 @@
 
 #include "jottie_LottieAnimation.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <utility>
 
 namespace jottie {
 namespace {
 
 //==============================================================================
-Lottie_Animation* createAnimation (const juce::String& jsonData)
+// with a render budget, a frame every this many is rasterised over the whole canvas for the quality governor to time
+constexpr int framesPerTimedRender = 4;
+
+//==============================================================================
+Lottie_Animation* createAnimation (const LottieModelCache::ModelPtr& model)
+{
+    return model != nullptr ? lottie_animation_from_model (model.get()) : nullptr;
+}
+
+juce::String getModelKey (const LottieContentHash& jsonDataHash)
+{
+    return "data:" + jsonDataHash.toString();
+}
+
+juce::String getModelKey (const juce::File& jsonFile)
+{
+    juce::String key;
+    key << "file:" << jsonFile.getFullPathName() << ":" << jsonFile.getLastModificationTime().toMilliseconds();
+
+    return key;
+}
+
+LottieModelCache::ModelPtr createModel (const juce::String& modelKey, const juce::File& jsonFile)
 {
-    const auto hash = juce::String (jsonData.hashCode());
+    if (! jsonFile.existsAsFile())
+        return nullptr;
 
-    return lottie_animation_from_data (jsonData.getCharPointer(), hash.getCharPointer(), "/");
+    return LottieModelCache::getInstance()->getOrLoadModel (modelKey, jsonFile);
 }
 
 void destroyAnimation (Lottie_Animation* animation)
@@ -72,19 +98,69 @@ juce::Rectangle<int> getAnimationSize (Lottie_Animation* animation)
     return juce::Rectangle<int>{ 0, 0, static_cast<int> (width), static_cast<int> (height) };
 }
 
-void renderAnimationToImage (Lottie_Animation* animation, juce::Image& image, int currentFrame)
+juce::Rectangle<int> getAnimationDamagedRegion (Lottie_Animation* animation)
+{
+    std::size_t x = 0;
+    std::size_t y = 0;
+    std::size_t width = 0;
+    std::size_t height = 0;
+
+    lottie_animation_get_damaged_region (animation, std::addressof (x), std::addressof (y), std::addressof (width), std::addressof (height));
+
+    return juce::Rectangle<int>{ static_cast<int> (x), static_cast<int> (y), static_cast<int> (width), static_cast<int> (height) };
+}
+
+juce::Rectangle<int> renderAnimationToImage (Lottie_Animation* animation, juce::Image& image, int currentFrame,
+                                             const juce::Rectangle<int>& area, bool incremental)
 {
     if (animation == nullptr || ! image.isValid())
-        return;
+        return {};
+
+    // pixels outside the area or that didn't change are kept, so the image content must be preserved
+    const auto isPartial = incremental || area != image.getBounds();
 
-    juce::Image::BitmapData bitmapData (image, juce::Image::BitmapData::ReadWriteMode::writeOnly);
+    juce::Image::BitmapData bitmapData (image, isPartial ? juce::Image::BitmapData::ReadWriteMode::readWrite
+                                                         : juce::Image::BitmapData::ReadWriteMode::writeOnly);
 
-    lottie_animation_render (animation,
-                             static_cast<std::size_t> (currentFrame),
-                             reinterpret_cast<uint32_t*> (bitmapData.data),
-                             static_cast<std::size_t> (bitmapData.width),
-                             static_cast<std::size_t> (bitmapData.height),
-                             static_cast<std::size_t> (bitmapData.lineStride));
+    lottie_animation_render_clipped (animation,
+                                     static_cast<std::size_t> (currentFrame),
+                                     reinterpret_cast<uint32_t*> (bitmapData.data),
+                                     static_cast<std::size_t> (bitmapData.width),
+                                     static_cast<std::size_t> (bitmapData.height),
+                                     static_cast<std::size_t> (bitmapData.lineStride),
+                                     static_cast<std::size_t> (area.getX()),
+                                     static_cast<std::size_t> (area.getY()),
+                                     static_cast<std::size_t> (area.getWidth()),
+                                     static_cast<std::size_t> (area.getHeight()),
+                                     incremental ? 1 : 0);
+
+    return getAnimationDamagedRegion (animation);
+}
+
+std::unique_ptr<juce::Image::BitmapData> renderAnimationToImageAsync (Lottie_Animation* animation, juce::Image& image, int currentFrame,
+                                                                      const juce::Rectangle<int>& area, bool incremental)
+{
+    if (animation == nullptr || ! image.isValid())
+        return {};
+
+    const auto isPartial = incremental || area != image.getBounds();
+
+    auto bitmapData = std::make_unique<juce::Image::BitmapData> (image, isPartial ? juce::Image::BitmapData::ReadWriteMode::readWrite
+                                                                                  : juce::Image::BitmapData::ReadWriteMode::writeOnly);
+
+    lottie_animation_render_clipped_async (animation,
+                                           static_cast<std::size_t> (currentFrame),
+                                           reinterpret_cast<uint32_t*> (bitmapData->data),
+                                           static_cast<std::size_t> (bitmapData->width),
+                                           static_cast<std::size_t> (bitmapData->height),
+                                           static_cast<std::size_t> (bitmapData->lineStride),
+                                           static_cast<std::size_t> (area.getX()),
+                                           static_cast<std::size_t> (area.getY()),
+                                           static_cast<std::size_t> (area.getWidth()),
+                                           static_cast<std::size_t> (area.getHeight()),
+                                           incremental ? 1 : 0);
+
+    return bitmapData;
 }
 
 juce::Result setAnimationPropertyOverride (Lottie_Animation* animation, LottieAnimation::Property property, const juce::String& keyPath, const juce::Colour& color)
@@ -154,23 +230,61 @@ juce::Result setAnimationPropertyOverride (Lottie_Animation* animation, LottieAn
 
 //==============================================================================
 LottieAnimation::LottieAnimation (const juce::String& data)
-    : animation (createAnimation (data))
+    : LottieAnimation (data, LottieContentHash::compute (data))
+{
+}
+
+LottieAnimation::LottieAnimation (const juce::String& data, const LottieContentHash& dataHash)
+    : LottieAnimation (dataHash, [&data] { return data; })
+{
+    jassert (dataHash.size == data.getNumBytesAsUTF8());
+}
+
+LottieAnimation::LottieAnimation (const LottieContentHash& dataHash, const std::function<juce::String()>& getData)
+    : modelKey (getModelKey (dataHash))
+    , model (LottieModelCache::getInstance()->getOrParseModel (modelKey, getData))
+    , animation (createAnimation (model))
     , numFrames (getAnimationNumFrames (animation))
     , frameRate (getAnimationFrameRate (animation))
+    , frameCacheKey (modelKey)
+{
+}
+
+LottieAnimation::LottieAnimation (const juce::File& jsonFile)
+    : modelKey (getModelKey (jsonFile))
+    , model (createModel (modelKey, jsonFile))
+    , animation (createAnimation (model))
+    , numFrames (getAnimationNumFrames (animation))
+    , frameRate (getAnimationFrameRate (animation))
+    , frameCacheKey (modelKey)
 {
 }
 
 LottieAnimation::~LottieAnimation()
 {
+    // the render callback is called before a frame is finished, so it's not going to be called anymore after this
+    destroyRenderJobs();
+
     destroyAnimation (animation);
 }
 
+//==============================================================================
+bool LottieAnimation::isModelCached (const LottieContentHash& dataHash)
+{
+    return LottieModelCache::getInstance()->containsModel (getModelKey (dataHash));
+}
+
 //==============================================================================
 bool LottieAnimation::isValid() const
 {
     return animation != nullptr && canvas.isValid();
 }
 
+bool LottieAnimation::hasModel() const
+{
+    return animation != nullptr;
+}
+
 //==============================================================================
 void LottieAnimation::setSize (int width, int height)
 {
@@ -180,10 +294,15 @@ void LottieAnimation::setSize (int width, int height)
     const auto newSize = getScaledSize();
     if (newSize.getWidth() != canvas.getWidth() || newSize.getHeight() != canvas.getHeight())
     {
-        canvas = juce::Image (juce::Image::ARGB, newSize.getWidth(), newSize.getHeight(), true);
+        collectPendingFrames (true);
+        discardPrefetchedFrames();
 
-        if (canRenderCurrentFrame())
-            renderAnimationToImage (animation, canvas, currentFrame);
+        // the canvas is only rasterised when rendered, and then only the visible area of it
+        canvas = juce::Image (juce::Image::ARGB, newSize.getWidth(), newSize.getHeight(), true);
+        spareCanvases.clear();
+        lastFrame = -1;
+        canvasHoldsLastRender = false;
+        canvasValidArea = {};
     }
 }
 
@@ -199,8 +318,8 @@ juce::Rectangle<int> LottieAnimation::getSize() const
 
 juce::Rectangle<int> LottieAnimation::getScaledSize() const
 {
-    auto newWidth = juce::roundToInt (static_cast<float> (originalWidth) * scaleFactor);
-    auto newHeight = juce::roundToInt (static_cast<float> (originalHeight) * scaleFactor);
+    auto newWidth = juce::roundToInt (static_cast<float> (originalWidth) * getRenderScale());
+    auto newHeight = juce::roundToInt (static_cast<float> (originalHeight) * getRenderScale());
 
     return juce::Rectangle<int>(0, 0, newWidth, newHeight);
 }
@@ -228,6 +347,23 @@ float LottieAnimation::getScaleFactor() const
     return scaleFactor;
 }
 
+float LottieAnimation::getRenderScale() const
+{
+    return scaleFactor * deviceScale * renderQuality.renderScale;
+}
+
+void LottieAnimation::setDeviceScale (float newDeviceScale)
+{
+    newDeviceScale = juce::jmax (newDeviceScale, 0.0001f);
+
+    if (! juce::approximatelyEqual (deviceScale, newDeviceScale))
+    {
+        deviceScale = newDeviceScale;
+
+        setSize (originalWidth, originalHeight);
+    }
+}
+
 //==============================================================================
 int LottieAnimation::getNumFrames() const
 {
@@ -249,57 +385,755 @@ int LottieAnimation::getCurrentFrame() const
     return currentFrame;
 }
 
+int LottieAnimation::getRenderedFrame() const
+{
+    return lastFrame;
+}
+
+bool LottieAnimation::isFrameMoreRecent (int frameNumber, int otherFrameNumber) const
+{
+    if (frameNumber < 0 || isFrameAhead (frameNumber))
+        return false;
+
+    if (otherFrameNumber < 0 || isFrameAhead (otherFrameNumber))
+        return true;
+
+    // the frames behind the current one are the farthest ahead of it once wrapped around
+    return getPrefetchFrameDistance (frameNumber) == 0
+        || (getPrefetchFrameDistance (otherFrameNumber) != 0
+            && getPrefetchFrameDistance (frameNumber) > getPrefetchFrameDistance (otherFrameNumber));
+}
+
+juce::Rectangle<int> LottieAnimation::prepareCurrentFrame (const juce::Rectangle<int>& visibleArea)
+{
+    // asynchronous frames are presented when rendering, as soon as they are ready
+    if (renderMode == RenderMode::Asynchronous)
+        return getSize();
+
+    // the canvas has been rasterised again from scratch at the new quality
+    const auto qualityChanged = applyRenderQuality();
+
+    const auto canvasToAnimation = juce::AffineTransform::scale (1.0f / getRenderScale());
+
+    const auto changedArea = renderCurrentFrame (getCanvasArea (visibleArea, canvasToAnimation));
+    if (qualityChanged)
+        return getSize();
+
+    if (changedArea.isEmpty() || juce::approximatelyEqual (getRenderScale(), 1.0f))
+        return changedArea;
+
+    // the canvas is resampled when rendered, so the neighbouring pixels are affected as well
+    return changedArea.toFloat().transformedBy (canvasToAnimation).getSmallestIntegerContainer().expanded (1).getIntersection (getSize());
+}
+
+void LottieAnimation::submitCurrentFrame (const juce::Rectangle<int>& visibleArea)
+{
+    // asynchronous frames are already rasterised in background when rendering
+    // a change of quality reallocates the canvas, it's left to the frame preparation
+    if (renderMode == RenderMode::Asynchronous || preparingFrame >= 0 || renderQualityChanged || ! canRenderCurrentFrame())
+        return;
+
+    const auto area = getCanvasArea (visibleArea, juce::AffineTransform::scale (1.0f / getRenderScale()));
+    if (area.isEmpty() || (lastFrame == currentFrame && canvasValidArea.contains (area)) || isFrameCached (currentFrame))
+        return;
+
+    // the canvas could be still referenced by the frame cache
+    if (canvas.getReferenceCount() > 1)
+    {
+        canvas = juce::Image (canvas.getFormat(), canvas.getWidth(), canvas.getHeight(), true);
+        canvasHoldsLastRender = false;
+    }
+
+    const auto timedRender = isTimedRenderDue();
+    const auto renderArea = timedRender ? canvas.getBounds() : area;
+
+    preparingStartTime = juce::Time::getMillisecondCounterHiRes();
+    preparingBitmapData = renderAnimationToImageAsync (animation, canvas, currentFrame, renderArea, canvasHoldsLastRender && ! timedRender);
+
+    if (preparingBitmapData != nullptr)
+    {
+        preparingFrame = currentFrame;
+        preparingArea = renderArea;
+    }
+}
+
+//==============================================================================
+void LottieAnimation::setRenderMode (RenderMode newRenderMode)
+{
+    if (renderMode == newRenderMode)
+        return;
+
+    destroyRenderJobs();
+    discardPrefetchedFrames();
+
+    renderMode = newRenderMode;
+    spareCanvases.clear();
+    canvasHoldsLastRender = false;
+    canvasValidArea = canvas.getBounds();
+}
+
+LottieAnimation::RenderMode LottieAnimation::getRenderMode() const
+{
+    return renderMode;
+}
+
+void LottieAnimation::addListener (Listener* listener)
+{
+    listeners.add (listener);
+}
+
+void LottieAnimation::removeListener (Listener* listener)
+{
+    listeners.remove (listener);
+}
+
+bool LottieAnimation::isFramePending() const
+{
+    return renderMode == RenderMode::Asynchronous
+        && canRenderCurrentFrame()
+        && lastFrame != currentFrame;
+}
+
+//==============================================================================
+void LottieAnimation::setNumPrefetchFrames (int numFramesToPrefetch)
+{
+    numFramesToPrefetch = juce::jmax (0, numFramesToPrefetch);
+
+    if (numPrefetchFrames == numFramesToPrefetch)
+        return;
+
+    // the instances rasterising in background are created again as needed
+    destroyRenderJobs();
+
+    numPrefetchFrames = numFramesToPrefetch;
+}
+
+int LottieAnimation::getNumPrefetchFrames() const
+{
+    return numPrefetchFrames;
+}
+
+void LottieAnimation::setPlaybackStep (int newPlaybackStep)
+{
+    playbackStep = newPlaybackStep != 0 ? newPlaybackStep : 1;
+}
+
+int LottieAnimation::getPlaybackStep() const
+{
+    return playbackStep;
+}
+
+//==============================================================================
+void LottieAnimation::setFrameCachingEnabled (bool shouldCacheFrames)
+{
+    frameCachingEnabled = shouldCacheFrames;
+}
+
+bool LottieAnimation::isFrameCachingEnabled() const
+{
+    return frameCachingEnabled;
+}
+
+void LottieAnimation::clearFrameCache()
+{
+    LottieFrameCache::getInstance()->removeFrames (frameCacheKey);
+}
+
+//==============================================================================
+void LottieAnimation::setRenderBudget (double frameBudgetMilliseconds, int axesToDegrade)
+{
+    if (frameBudgetMilliseconds <= 0.0)
+    {
+        qualityGovernor.reset();
+    }
+    else if (qualityGovernor == nullptr)
+    {
+        qualityGovernor = std::make_unique<LottieQualityGovernor> (frameBudgetMilliseconds, axesToDegrade);
+    }
+    else
+    {
+        qualityGovernor->setFrameBudget (frameBudgetMilliseconds);
+        qualityGovernor->setAxes (axesToDegrade);
+    }
+
+    renderQualityChanged = true;
+}
+
+double LottieAnimation::getRenderBudget() const
+{
+    return qualityGovernor != nullptr ? qualityGovernor->getFrameBudget() : 0.0;
+}
+
+LottieQualityGovernor::Quality LottieAnimation::getRenderQuality() const
+{
+    return qualityGovernor != nullptr ? qualityGovernor->getQuality() : LottieQualityGovernor::Quality();
+}
+
 //==============================================================================
 juce::Result LottieAnimation::setPropertyOverride (Property property, const juce::String& keyPath, const juce::Colour& color)
 {
-    return setAnimationPropertyOverride (animation, property, keyPath, color);
+    const auto description = juce::String (static_cast<int> (property)) + ":" + keyPath + "=" + color.toString();
+
+    return applyPropertyOverride (description, [property, keyPath, color] (Lottie_Animation* target)
+    {
+        return setAnimationPropertyOverride (target, property, keyPath, color);
+    });
 }
 
 juce::Result LottieAnimation::setPropertyOverride (Property property, const juce::String& keyPath, float value)
 {
-    return setAnimationPropertyOverride (animation, property, keyPath, value);
+    const auto description = juce::String (static_cast<int> (property)) + ":" + keyPath + "=" + juce::String (value);
+
+    return applyPropertyOverride (description, [property, keyPath, value] (Lottie_Animation* target)
+    {
+        return setAnimationPropertyOverride (target, property, keyPath, value);
+    });
 }
 
 juce::Result LottieAnimation::setPropertyOverride (Property property, const juce::String& keyPath, const juce::Range<int>& range)
 {
-    return setAnimationPropertyOverride (animation, property, keyPath, range);
+    const auto description = juce::String (static_cast<int> (property)) + ":" + keyPath + "=" + juce::String (range.getStart()) + "," + juce::String (range.getEnd());
+
+    return applyPropertyOverride (description, [property, keyPath, range] (Lottie_Animation* target)
+    {
+        return setAnimationPropertyOverride (target, property, keyPath, range);
+    });
 }
 
 juce::Result LottieAnimation::setPropertyOverride (Property property, const juce::String& keyPath, const juce::Point<float>& point)
 {
-    return setAnimationPropertyOverride (animation, property, keyPath, point);
+    const auto description = juce::String (static_cast<int> (property)) + ":" + keyPath + "=" + point.toString();
+
+    return applyPropertyOverride (description, [property, keyPath, point] (Lottie_Animation* target)
+    {
+        return setAnimationPropertyOverride (target, property, keyPath, point);
+    });
+}
+
+juce::Result LottieAnimation::applyPropertyOverride (const juce::String& description, PropertyOverride propertyOverride)
+{
+    collectPendingFrames (true);
+    discardPrefetchedFrames();
+
+    lastFrame = -1;
+    canvasHoldsLastRender = false;
+
+    // the instances rasterising in background must render the same content
+    for (auto& job : renderJobs)
+    {
+        if (job->ownsAnimation)
+            propertyOverride (job->animation);
+    }
+
+    auto result = propertyOverride (animation);
+    if (result.wasOk())
+    {
+        propertyOverrides.push_back (std::move (propertyOverride));
+
+        // animations with the same content and the same overrides share their cached frames
+        propertyOverridesDescription << description << ";";
+        frameCacheKey = modelKey + "#" + LottieContentHash::compute (propertyOverridesDescription).toString();
+    }
+
+    return result;
 }
 
 //==============================================================================
 void LottieAnimation::render (juce::Graphics& g, juce::Point<int> topLeft)
 {
-    renderCurrentFrame();
+    setDeviceScale (g.getInternalContext().getPhysicalPixelScaleFactor());
+    applyRenderQuality();
+
+    if (juce::approximatelyEqual (getRenderScale(), 1.0f))
+    {
+        renderCurrentFrame (getCanvasArea (g.getClipBounds(), juce::AffineTransform::translation (topLeft.toFloat())));
 
-    if (juce::approximatelyEqual (scaleFactor, 1.0f))
         g.drawImageAt (canvas, topLeft.x, topLeft.y);
+    }
     else
-        g.drawImageTransformed (canvas, juce::AffineTransform::scale (1.0f / scaleFactor));
+    {
+        // at the physical pixel scale the context transform cancels out, so the canvas is blitted 1:1
+        const auto canvasTransform = juce::AffineTransform::scale (1.0f / getRenderScale())
+                                         .translated (topLeft.toFloat());
+
+        renderCurrentFrame (getCanvasArea (g.getClipBounds(), canvasTransform));
+
+        g.drawImageTransformed (canvas, canvasTransform);
+    }
 }
 
 void LottieAnimation::render (juce::Graphics& g, const juce::AffineTransform& transform)
 {
-    renderCurrentFrame();
+    setDeviceScale (g.getInternalContext().getPhysicalPixelScaleFactor());
+    applyRenderQuality();
 
-    if (juce::approximatelyEqual (scaleFactor, 1.0f))
-        g.drawImageTransformed (canvas, transform);
-    else
-        g.drawImageTransformed (canvas, transform.scaled (1.0f / scaleFactor));
+    const auto canvasTransform = juce::approximatelyEqual (getRenderScale(), 1.0f)
+        ? transform
+        : juce::AffineTransform::scale (1.0f / getRenderScale()).followedBy (transform);
+
+    renderCurrentFrame (getCanvasArea (g.getClipBounds(), canvasTransform));
+
+    g.drawImageTransformed (canvas, canvasTransform);
 }
 
 //==============================================================================
-void LottieAnimation::renderCurrentFrame()
+void LottieAnimation::renderFinished (void* userData)
+{
+    // called on the rLottie render thread that rasterised the frame
+    auto job = static_cast<RenderJob*> (userData);
+
+    job->finished = true;
+    job->owner->triggerAsyncUpdate();
+}
+
+void LottieAnimation::handleAsyncUpdate()
 {
-    if (canRenderCurrentFrame() && lastFrame != currentFrame)
+    if (renderMode != RenderMode::Asynchronous)
+        return;
+
+    // the frames could have been collected when rendering already, or others submitted in the meantime
+    std::vector<int> readyFrames;
+
+    for (auto& job : renderJobs)
+    {
+        const auto frameNumber = job->frameNumber;
+
+        if (job->finished.load() && collectRenderJob (*job, true))
+            readyFrames.push_back (frameNumber);
+    }
+
+    if (readyFrames.empty())
+        return;
+
+    if (canRenderCurrentFrame())
+        schedulePrefetchFrames();
+
+    for (const auto frameNumber : readyFrames)
+        listeners.call (&Listener::animationFrameReady, this, frameNumber);
+}
+
+//==============================================================================
+juce::Rectangle<int> LottieAnimation::renderCurrentFrame (const juce::Rectangle<int>& area)
+{
+    if (renderMode == RenderMode::Asynchronous)
+    {
+        const auto previousFrame = lastFrame;
+
+        collectPendingFrames (false);
+
+        if (canRenderCurrentFrame())
+        {
+            presentPrefetchedFrame();
+            schedulePrefetchFrames();
+        }
+
+        return lastFrame != previousFrame ? canvas.getBounds() : juce::Rectangle<int>();
+    }
+
+    // the frame submitted ahead of rendering is in the canvas already, it only needs to be finished
+    auto changedArea = collectPreparedFrame();
+
+    // nothing of the animation is going to be visible
+    if (area.isEmpty())
+        return changedArea;
+
+    if (canRenderCurrentFrame() && (lastFrame != currentFrame || ! canvasValidArea.contains (area)))
     {
-        renderAnimationToImage (animation, canvas, currentFrame);
+        if (presentCachedFrame (currentFrame))
+        {
+            changedArea = canvas.getBounds();
+            canvasHoldsLastRender = false;
+            canvasValidArea = canvas.getBounds();
+        }
+        else
+        {
+            // the canvas could be still referenced by the frame cache
+            if (canvas.getReferenceCount() > 1)
+            {
+                canvas = juce::Image (canvas.getFormat(), canvas.getWidth(), canvas.getHeight(), true);
+                canvasHoldsLastRender = false;
+            }
+
+            // when the canvas holds the previous frame only the area that changed is rendered again, and only the
+            // visible area of the canvas is rendered at all, unless the frame is to be timed
+            const auto timedRender = isTimedRenderDue();
+            const auto renderArea = timedRender ? canvas.getBounds() : area;
+            const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+            const auto renderedArea = renderAnimationToImage (animation, canvas, currentFrame, renderArea, canvasHoldsLastRender && ! timedRender);
+
+            addFrameRenderTime (juce::Time::getMillisecondCounterHiRes() - startTime, renderedArea);
+            changedArea = changedArea.getUnion (renderedArea);
+            canvasHoldsLastRender = true;
+            canvasValidArea = renderArea;
+
+            if (frameCachingEnabled && renderArea == canvas.getBounds())
+                LottieFrameCache::getInstance()->addFrame (getFrameCacheKey (currentFrame), canvas);
+        }
 
         lastFrame = currentFrame;
     }
+
+    return changedArea;
+}
+
+LottieAnimation::RenderJob* LottieAnimation::getIdleRenderJob()
+{
+    for (auto& job : renderJobs)
+    {
+        if (job->frameNumber < 0)
+            return job.get();
+    }
+
+    // each instance of the animation can only rasterise one frame at a time
+    if (static_cast<int> (renderJobs.size()) >= juce::jmax (1, numPrefetchFrames))
+        return nullptr;
+
+    auto job = std::make_unique<RenderJob>();
+    job->owner = this;
+
+    if (renderJobs.empty())
+    {
+        job->animation = animation;
+    }
+    else
+    {
+        job->animation = createAnimation (model);
+        job->ownsAnimation = true;
+
+        if (job->animation == nullptr)
+            return nullptr;
+
+        for (const auto& propertyOverride : propertyOverrides)
+            propertyOverride (job->animation);
+
+        lottie_animation_set_antialiasing (job->animation, renderQuality.antiAliasing ? 1 : 0);
+    }
+
+    lottie_animation_set_render_callback (job->animation, renderFinished, job.get());
+
+    renderJobs.push_back (std::move (job));
+    return renderJobs.back().get();
+}
+
+void LottieAnimation::destroyRenderJobs()
+{
+    collectPendingFrames (true);
+
+    for (auto& job : renderJobs)
+    {
+        if (job->ownsAnimation)
+            destroyAnimation (job->animation);
+        else
+            lottie_animation_set_render_callback (job->animation, nullptr, nullptr);
+    }
+
+    renderJobs.clear();
+}
+
+void LottieAnimation::submitFrame (RenderJob& job, int frameNumber)
+{
+    jassert (job.frameNumber < 0);
+
+    job.canvas = getSpareCanvas();
+    job.finished = false;
+    job.bitmapData = renderAnimationToImageAsync (job.animation, job.canvas, frameNumber, job.canvas.getBounds(), false);
+
+    if (job.bitmapData != nullptr)
+        job.frameNumber = frameNumber;
+}
+
+bool LottieAnimation::collectRenderJob (RenderJob& job, bool waitForCompletion)
+{
+    if (job.frameNumber < 0)
+        return false;
+
+    if (! waitForCompletion && lottie_animation_render_ready (job.animation) == 0)
+        return false;
+
+    lottie_animation_render_flush (job.animation);
+    job.bitmapData.reset();
+
+    if (frameCachingEnabled)
+        LottieFrameCache::getInstance()->addFrame (getFrameCacheKey (job.frameNumber), job.canvas);
+
+    prefetchedFrames.push_back ({ job.frameNumber, std::move (job.canvas) });
+
+    job.canvas = {};
+    job.frameNumber = -1;
+
+    return true;
+}
+
+void LottieAnimation::collectPendingFrames (bool waitForCompletion)
+{
+    collectPreparedFrame();
+
+    for (auto& job : renderJobs)
+        collectRenderJob (*job, waitForCompletion);
+}
+
+juce::Rectangle<int> LottieAnimation::collectPreparedFrame()
+{
+    if (preparingFrame < 0)
+        return {};
+
+    lottie_animation_render_flush (animation);
+    preparingBitmapData.reset();
+
+    const auto changedArea = getAnimationDamagedRegion (animation);
+
+    // the frame is rasterised concurrently with the others submitted, this is the time it held up its presentation
+    addFrameRenderTime (juce::Time::getMillisecondCounterHiRes() - preparingStartTime, changedArea);
+
+    lastFrame = preparingFrame;
+    canvasHoldsLastRender = true;
+    canvasValidArea = preparingArea;
+
+    if (frameCachingEnabled && preparingArea == canvas.getBounds())
+        LottieFrameCache::getInstance()->addFrame (getFrameCacheKey (preparingFrame), canvas);
+
+    preparingFrame = -1;
+
+    return changedArea;
+}
+
+void LottieAnimation::presentPrefetchedFrame()
+{
+    if (lastFrame != currentFrame)
+    {
+        auto it = std::find_if (prefetchedFrames.begin(), prefetchedFrames.end(),
+                                [this] (const auto& frame) { return frame.frameNumber == currentFrame; });
+
+        if (it != prefetchedFrames.end())
+        {
+            std::swap (canvas, it->image);
+            lastFrame = currentFrame;
+
+            spareCanvases.push_back (std::move (it->image));
+            prefetchedFrames.erase (it);
+        }
+        else if (presentCachedFrame (currentFrame))
+        {
+            lastFrame = currentFrame;
+        }
+        else
+        {
+            // when rasterising is slower than playback the current frame is never ready in time, the most recent one
+            // that is ready is displayed instead, so the animation lags behind rather than freezing
+            auto mostRecent = prefetchedFrames.end();
+
+            for (auto candidate = prefetchedFrames.begin(); candidate != prefetchedFrames.end(); ++candidate)
+            {
+                if (isFrameMoreRecent (candidate->frameNumber, mostRecent != prefetchedFrames.end() ? mostRecent->frameNumber : lastFrame))
+                    mostRecent = candidate;
+            }
+
+            if (mostRecent != prefetchedFrames.end())
+            {
+                std::swap (canvas, mostRecent->image);
+                lastFrame = mostRecent->frameNumber;
+
+                spareCanvases.push_back (std::move (mostRecent->image));
+                prefetchedFrames.erase (mostRecent);
+            }
+        }
+    }
+
+    // drop the frames that have been passed, or are too far ahead to be displayed soon, keeping the ones not
+    // predicted by the current playback step as it could vary when frames are dropped
+    for (auto it = prefetchedFrames.begin(); it != prefetchedFrames.end();)
+    {
+        if (isFrameAhead (it->frameNumber))
+        {
+            ++it;
+            continue;
+        }
+
+        spareCanvases.push_back (std::move (it->image));
+        it = prefetchedFrames.erase (it);
+    }
+
+    // when over the budget, the farthest frames go first
+    std::sort (prefetchedFrames.begin(), prefetchedFrames.end(), [this] (const auto& a, const auto& b)
+    {
+        return getPrefetchFrameDistance (a.frameNumber) < getPrefetchFrameDistance (b.frameNumber);
+    });
+
+    while (prefetchedFrames.size() > static_cast<std::size_t> (numPrefetchFrames))
+    {
+        spareCanvases.push_back (std::move (prefetchedFrames.back().image));
+        prefetchedFrames.pop_back();
+    }
+
+    while (spareCanvases.size() > static_cast<std::size_t> (numPrefetchFrames + 1))
+        spareCanvases.pop_back();
+}
+
+void LottieAnimation::schedulePrefetchFrames()
+{
+    // the frames predicted by the playback step are submitted in order, as many at once as there are instances
+    for (int offset = 0; offset <= numPrefetchFrames; ++offset)
+    {
+        const auto frameNumber = getPrefetchFrameNumber (offset);
+
+        if (frameNumber == lastFrame || isFramePrefetched (frameNumber) || isFrameRendering (frameNumber) || isFrameCached (frameNumber))
+            continue;
+
+        auto job = getIdleRenderJob();
+        if (job == nullptr)
+            break;
+
+        submitFrame (*job, frameNumber);
+    }
+}
+
+void LottieAnimation::discardPrefetchedFrames()
+{
+    for (auto& frame : prefetchedFrames)
+        spareCanvases.push_back (std::move (frame.image));
+
+    prefetchedFrames.clear();
+}
+
+int LottieAnimation::getPrefetchFrameNumber (int offset) const
+{
+    if (numFrames <= 0)
+        return 0;
+
+    const auto frameNumber = (currentFrame + offset * playbackStep) % numFrames;
+
+    return frameNumber < 0 ? frameNumber + numFrames : frameNumber;
+}
+
+int LottieAnimation::getPrefetchFrameDistance (int frameNumber) const
+{
+    if (numFrames <= 0)
+        return 0;
+
+    const auto distance = ((frameNumber - currentFrame) * (playbackStep < 0 ? -1 : 1)) % numFrames;
+
+    return distance < 0 ? distance + numFrames : distance;
+}
+
+bool LottieAnimation::isFrameAhead (int frameNumber) const
+{
+    const auto distance = getPrefetchFrameDistance (frameNumber);
+
+    return distance > 0 && distance <= numPrefetchFrames * std::abs (playbackStep);
+}
+
+bool LottieAnimation::isFramePrefetched (int frameNumber) const
+{
+    return std::any_of (prefetchedFrames.begin(), prefetchedFrames.end(),
+                        [frameNumber] (const auto& frame) { return frame.frameNumber == frameNumber; });
+}
+
+bool LottieAnimation::isFrameRendering (int frameNumber) const
+{
+    return std::any_of (renderJobs.begin(), renderJobs.end(),
+                        [frameNumber] (const auto& job) { return job->frameNumber == frameNumber; });
+}
+
+juce::Image LottieAnimation::getSpareCanvas()
+{
+    while (! spareCanvases.empty())
+    {
+        auto image = std::move (spareCanvases.back());
+        spareCanvases.pop_back();
+
+        // skip the canvases still referenced by the frame cache
+        if (image.getWidth() == canvas.getWidth() && image.getHeight() == canvas.getHeight() && image.getReferenceCount() == 1)
+            return image;
+    }
+
+    return juce::Image (canvas.getFormat(), canvas.getWidth(), canvas.getHeight(), true);
+}
+
+bool LottieAnimation::presentCachedFrame (int frameNumber)
+{
+    return frameCachingEnabled && LottieFrameCache::getInstance()->getFrame (getFrameCacheKey (frameNumber), canvas);
+}
+
+bool LottieAnimation::isFrameCached (int frameNumber) const
+{
+    return frameCachingEnabled && LottieFrameCache::getInstance()->containsFrame (getFrameCacheKey (frameNumber));
+}
+
+LottieFrameCache::Key LottieAnimation::getFrameCacheKey (int frameNumber) const
+{
+    return { frameCacheKey, frameNumber, canvas.getWidth(), canvas.getHeight(), renderQuality.antiAliasing };
+}
+
+void LottieAnimation::addFrameRenderTime (double milliseconds, const juce::Rectangle<int>& renderedArea)
+{
+    // the incremental and clipped frames only rasterise part of the canvas, they would hide a budget being overrun by
+    // the whole frames when averaged with them
+    if (qualityGovernor == nullptr || renderedArea != canvas.getBounds())
+        return;
+
+    framesSinceTimedRender = 0;
+
+    // the new quality is applied before the next frame, the canvas is still in use for this one
+    if (qualityGovernor->addFrameRenderTime (milliseconds))
+        renderQualityChanged = true;
+}
+
+bool LottieAnimation::isTimedRenderDue()
+{
+    return qualityGovernor != nullptr && ++framesSinceTimedRender >= framesPerTimedRender;
+}
+
+bool LottieAnimation::applyRenderQuality()
+{
+    if (! std::exchange (renderQualityChanged, false))
+        return false;
+
+    const auto newRenderQuality = getRenderQuality();
+    if (newRenderQuality == renderQuality)
+        return false;
+
+    collectPendingFrames (true);
+    discardPrefetchedFrames();
+
+    if (newRenderQuality.antiAliasing != renderQuality.antiAliasing)
+    {
+        lottie_animation_set_antialiasing (animation, newRenderQuality.antiAliasing ? 1 : 0);
+
+        for (auto& job : renderJobs)
+        {
+            if (job->ownsAnimation)
+                lottie_animation_set_antialiasing (job->animation, newRenderQuality.antiAliasing ? 1 : 0);
+        }
+
+        // the canvas holds a frame rasterised at the previous quality
+        lastFrame = -1;
+        canvasHoldsLastRender = false;
+    }
+
+    renderQuality = newRenderQuality;
+
+    setSize (originalWidth, originalHeight);
+
+    return true;
+}
+
+juce::Rectangle<int> LottieAnimation::getCanvasArea (const juce::Rectangle<int>& area, const juce::AffineTransform& canvasTransform) const
+{
+    if (canvasTransform.isSingularity())
+        return canvas.getBounds();
+
+    auto canvasArea = area.toFloat().transformedBy (canvasTransform.inverted());
+
+    // the canvas is resampled when not drawn at integer offsets, so the neighbouring pixels are needed as well
+    const auto isIntegerTranslation = canvasTransform.isOnlyTranslation()
+        && juce::exactlyEqual (std::round (canvasTransform.getTranslationX()), canvasTransform.getTranslationX())
+        && juce::exactlyEqual (std::round (canvasTransform.getTranslationY()), canvasTransform.getTranslationY());
+
+    if (! isIntegerTranslation)
+        canvasArea = canvasArea.expanded (1.0f);
+
+    return canvasArea.getSmallestIntegerContainer().getIntersection (canvas.getBounds());
 }
 
 bool LottieAnimation::canRenderCurrentFrame() const
@@ -37,6 +37,15 @@
 
 #include "../rlottie/inc/rlottie_capi.h"
 
+#include "jottie_LottieContentHash.h"
+#include "jottie_LottieFrameCache.h"
+#include "jottie_LottieModelCache.h"
+#include "jottie_LottieQualityGovernor.h"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
 namespace jottie {
 
 //==============================================================================
@@ -46,7 +55,7 @@ namespace jottie {
  * The `LottieAnimation` class provides functionality to load and render Lottie animations, as well as the
  * ability to customize various animation properties, like fill color, stroke color, opacity, etc.
  */
-class LottieAnimation : public juce::ReferenceCountedObject
+class LottieAnimation : public juce::ReferenceCountedObject, private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -73,31 +82,123 @@ public:
         TransformOpacity    = LOTTIE_ANIMATION_PROPERTY_TR_OPACITY
     };
 
+    //==============================================================================
+    /**
+     * @brief Enumerates the ways frames of the Lottie animation can be rasterised.
+     */
+    enum class RenderMode
+    {
+        Synchronous,        ///< Frames are rasterised on the calling thread when rendering.
+        Asynchronous        ///< Frames are rasterised on the rLottie render threads into a back buffer.
+    };
+
+    //==============================================================================
+    /**
+     * @brief An abstract class for receiving the frames rasterised in background.
+     */
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /**
+         * @brief Called on the message thread when a frame rasterised in `RenderMode::Asynchronous` mode is ready.
+         *
+         * The frame is not displayed until the animation is rendered again, so this is where to repaint it.
+         *
+         * @param animation The animation the frame belongs to.
+         * @param frameNumber The number of the frame that is ready.
+         */
+        virtual void animationFrameReady (LottieAnimation* animation, int frameNumber) = 0;
+    };
+
     //==============================================================================
     /**
      * @brief Constructs a `LottieAnimation` from Lottie animation data.
      *
+     * The parsed animation is shared through the `LottieModelCache`, so constructing many animations from the same
+     * data only parses it once.
+     *
      * @param data A string containing Lottie animation data.
      */
     LottieAnimation (const juce::String& data);
 
+    /**
+     * @brief Constructs a `LottieAnimation` from Lottie animation data and its precomputed hash.
+     *
+     * Use this when the same data is instantiated repeatedly, to avoid hashing it again on every construction.
+     *
+     * @param data A string containing Lottie animation data.
+     * @param dataHash The hash of the data, as returned by `LottieContentHash::compute (data)`.
+     */
+    LottieAnimation (const juce::String& data, const LottieContentHash& dataHash);
+
+    /**
+     * @brief Constructs a `LottieAnimation` from the hash of Lottie animation data, loading the data only if needed.
+     *
+     * When the animation with the given hash is in the `LottieModelCache` already, the data is not requested at all,
+     * which allows to skip reading and decompressing it.
+     *
+     * @param dataHash The hash of the data, as returned by `LottieContentHash::compute (data)`.
+     * @param getData A function returning the data, only called when the animation is not in the model cache.
+     */
+    LottieAnimation (const LottieContentHash& dataHash, const std::function<juce::String()>& getData);
+
+    /**
+     * @brief Constructs a `LottieAnimation` from a Lottie animation json file.
+     *
+     * The parsed animation is shared through the `LottieModelCache` by file path and modification time, so the file is
+     * only read and parsed again when it changes on disk. The file is memory mapped and parsed in place, which avoids
+     * copying the content of large animations in memory.
+     *
+     * @param jsonFile The file containing Lottie animation data.
+     */
+    LottieAnimation (const juce::File& jsonFile);
+
     /**
      * @brief Destroys the `LottieAnimation` instance.
      */
     ~LottieAnimation();
 
+    //==============================================================================
+    /**
+     * @brief Checks if the animation with the given data hash is in the `LottieModelCache`.
+     *
+     * When it is, constructing the animation from its hash doesn't request the data at all.
+     *
+     * @param dataHash The hash of the data, as returned by `LottieContentHash::compute (data)`.
+     *
+     * @return True if the parsed animation is cached, false otherwise.
+     */
+    static bool isModelCached (const LottieContentHash& dataHash);
+
     //==============================================================================
     /**
      * @brief Checks if the Lottie animation is valid and properly loaded.
      *
+     * The animation is only valid once it has been given a size, use `hasModel` to check whether it was parsed.
+     *
      * @return True if the animation is valid, false otherwise.
      */
     bool isValid() const;
 
+    /**
+     * @brief Checks if the Lottie animation data was parsed successfully.
+     *
+     * Unlike `isValid`, it doesn't need the animation to have been given a size, so it can be used to check an
+     * animation loaded on a background thread before it's handed to the message thread.
+     *
+     * @return True if the animation was parsed, false otherwise.
+     */
+    bool hasModel() const;
+
     //==============================================================================
     /**
      * @brief Sets the size of the animation in pixels.
      *
+     * When the scaled size changes the canvas is reallocated, the current frame is rasterised again the next time the
+     * animation is rendered.
+     *
      * @param width  The width of the animation.
      * @param height The height of the animation.
      */
@@ -118,7 +219,10 @@ public:
     juce::Rectangle<int> getSize() const;
 
     /**
-     * @brief Gets the scaled size of the animation, considering the scale factor.
+     * @brief Gets the scaled size of the animation, considering the scale factor, the render quality and the physical
+     *        pixel scale of the context it was last rendered on.
+     *
+     * This is the size of the canvas the frames are rasterised into.
      *
      * @return A `juce::Rectangle` representing the scaled size of the animation.
      */
@@ -135,6 +239,10 @@ public:
     /**
      * @brief Sets the scale factor for rendering the animation.
      *
+     * Frames are rasterised at the physical pixel scale of the context the animation is rendered on, so on HiDPI
+     * displays they are drawn at native resolution without being resampled. The scale factor is applied on top of
+     * it: values below 1 rasterise at a lower resolution and upscale the result, values above 1 supersample it.
+     *
      * @param newScaleFactor The new scale factor.
      */
     void setScaleFactor (float newScaleFactor);
@@ -175,6 +283,193 @@ public:
      */
     int getCurrentFrame() const;
 
+    /**
+     * @brief Gets the frame number held by the canvas, which is the one blitted when rendering.
+     *
+     * @return The frame number held by the canvas, or -1 if no frame has been rasterised yet.
+     */
+    int getRenderedFrame() const;
+
+    /**
+     * @brief Checks whether a frame is more recent than another one, relative to the current frame.
+     *
+     * The frames ahead of the current frame in the playback direction, that are prefetched to be displayed later, are
+     * never more recent. In `RenderMode::Asynchronous` mode it tells whether a frame that is ready will be displayed
+     * in place of the one rendered last.
+     *
+     * @param frameNumber      The frame to check.
+     * @param otherFrameNumber The frame to compare with, or -1 if there is none.
+     *
+     * @return True if the frame is not ahead of the current frame and is closer to it than the other one.
+     */
+    bool isFrameMoreRecent (int frameNumber, int otherFrameNumber) const;
+
+    /**
+     * @brief Rasterises the current frame ahead of rendering it, and returns the area that changed.
+     *
+     * In `RenderMode::Synchronous` mode, when the canvas still holds the frame rasterised last, only the area covered
+     * by the layers that changed since that frame is cleared and rasterised again. The returned area can be used to
+     * repaint only that portion of the component the animation is rendered into.
+     *
+     * @param visibleArea The area of the animation that is visible, in the same coordinates of `getSize`. Only this
+     *                    area is rasterised, the rest will be when it's rendered.
+     *
+     * @return The area changed since the frame held by the canvas, in the same coordinates of `getSize`. It covers the
+     *         whole visible area when the frame has been rasterised from scratch, and it's empty if nothing changed.
+     */
+    juce::Rectangle<int> prepareCurrentFrame (const juce::Rectangle<int>& visibleArea);
+
+    /**
+     * @brief Starts rasterising the current frame in background, to be finished by `prepareCurrentFrame` or `render`.
+     *
+     * Only used in `RenderMode::Synchronous` mode: it allows to submit the frames of many animations to the rLottie
+     * render threads at once, and wait for all of them afterwards. The canvas must not be used until the frame is
+     * finished, which any other call to the animation takes care of.
+     *
+     * @param visibleArea The area of the animation that is visible, in the same coordinates of `getSize`.
+     */
+    void submitCurrentFrame (const juce::Rectangle<int>& visibleArea);
+
+    //==============================================================================
+    /**
+     * @brief Sets how the frames of the animation are rasterised.
+     *
+     * In `RenderMode::Asynchronous` mode the frame is submitted to the rLottie render scheduler and rasterised into a
+     * back buffer, which is swapped in as soon as it is ready: rendering will only blit the last finished frame, so it
+     * could lag behind the current frame by one or more frames. The listeners are notified when a frame is ready, so
+     * whoever displays the animation knows when to render it again. Without `JOTTIE_ENABLE_THREAD_SUPPORT` the rLottie
+     * scheduler has no worker threads, so the asynchronous mode will behave like the synchronous one.
+     *
+     * @param newRenderMode The new render mode.
+     */
+    void setRenderMode (RenderMode newRenderMode);
+
+    /**
+     * @brief Gets the current render mode.
+     *
+     * @return The render mode used to rasterise the frames of the animation.
+     */
+    RenderMode getRenderMode() const;
+
+    /**
+     * @brief Add a listener to be notified when the frames rasterised in background are ready.
+     *
+     * @param listener A pointer to the listener object.
+     */
+    void addListener (Listener* listener);
+
+    /**
+     * @brief Remove a listener to stop being notified of the frames rasterised in background.
+     *
+     * @param listener A pointer to the listener object.
+     */
+    void removeListener (Listener* listener);
+
+    /**
+     * @brief Checks if the current frame is being rasterised asynchronously and has not been displayed yet.
+     *
+     * @return True if the current frame is not yet available for blitting.
+     */
+    bool isFramePending() const;
+
+    //==============================================================================
+    /**
+     * @brief Sets the number of frames to rasterise ahead of the current frame.
+     *
+     * Only used in `RenderMode::Asynchronous` mode: the next frames predicted from the playback step are rasterised
+     * in background into a small ring of canvases, so steady state playback only needs to swap in an already finished
+     * frame. Up to that many frames are rasterised at once, each by its own instance of the animation sharing the
+     * parsed model. Each prefetched frame costs a full canvas of memory.
+     *
+     * @param numFramesToPrefetch The number of frames to prefetch, 0 disables the prefetching.
+     */
+    void setNumPrefetchFrames (int numFramesToPrefetch);
+
+    /**
+     * @brief Gets the number of frames rasterised ahead of the current frame.
+     *
+     * @return The number of frames to prefetch.
+     */
+    int getNumPrefetchFrames() const;
+
+    /**
+     * @brief Sets how many frames the playback advances between the frames displayed, used to predict which frames
+     *        to prefetch.
+     *
+     * When frames are dropped to keep up with time, or only one every few frames is displayed, the frames skipped
+     * are not prefetched.
+     *
+     * @param newPlaybackStep The number of frames between two consecutive frames displayed, negative when playing
+     *                        backwards.
+     */
+    void setPlaybackStep (int newPlaybackStep);
+
+    /**
+     * @brief Gets how many frames the playback advances between the frames displayed.
+     *
+     * @return The number of frames between two consecutive frames displayed, negative when playing backwards.
+     */
+    int getPlaybackStep() const;
+
+    //==============================================================================
+    /**
+     * @brief Enables caching of the rendered frames in the process wide `LottieFrameCache`.
+     *
+     * Frames are cached by the content of the animation, property overrides included, and by the size they are
+     * rasterised at, so once every frame of a looping animation has been rendered, playback will only cost a blit.
+     * The cached frames are shared by all the animations with the same content, and survive the animation being
+     * loaded again. The memory budget and the compression of the cache are set on the `LottieFrameCache` singleton.
+     *
+     * @param shouldCacheFrames True to cache the rendered frames and present them when available.
+     */
+    void setFrameCachingEnabled (bool shouldCacheFrames);
+
+    /**
+     * @brief Checks if the rendered frames are cached.
+     *
+     * @return True if the frame caching is enabled.
+     */
+    bool isFrameCachingEnabled() const;
+
+    /**
+     * @brief Removes all the frames of this animation from the frame cache.
+     */
+    void clearFrameCache();
+
+    //==============================================================================
+    /**
+     * @brief Sets a budget for the time taken to rasterise a frame, adapting the quality to keep within it.
+     *
+     * The frames rasterised synchronously, or submitted ahead of rendering, are timed when they are rasterised over the
+     * whole canvas, the incremental, clipped and cached ones are not, so every few frames one is rasterised whole. When
+     * they take longer than the budget the quality is degraded along the given axes, and restored once there is enough
+     * headroom again.
+     *
+     * @param frameBudgetMilliseconds The time a frame should take to be rasterised at most, 0 disables the budget
+     *                                and restores the full quality.
+     * @param axesToDegrade The combination of `LottieQualityGovernor::Axis` flags the quality can be degraded along.
+     *
+     * @see LottieQualityGovernor
+     */
+    void setRenderBudget (double frameBudgetMilliseconds, int axesToDegrade = LottieQualityGovernor::AllAxes);
+
+    /**
+     * @brief Gets the time a frame should take to be rasterised at most.
+     *
+     * @return The budget in milliseconds, 0 if the budget is disabled.
+     */
+    double getRenderBudget() const;
+
+    /**
+     * @brief Gets the quality the frames are currently rendered at.
+     *
+     * The frame rate divisor is not applied by the animation itself, it's up to whoever advances the frames to only
+     * display one every that many frames.
+     *
+     * @return The current render quality.
+     */
+    LottieQualityGovernor::Quality getRenderQuality() const;
+
     //==============================================================================
     /**
      * @brief Overrides a property of the Lottie animation for a specific key path with a color value.
@@ -224,6 +519,8 @@ public:
     /**
      * @brief Renders the Lottie animation on a `juce::Graphics` context at the specified position.
      *
+     * Only the portion of the animation inside the clip bounds of the context is rasterised.
+     *
      * @param g        The `juce::Graphics` context to render the animation on.
      * @param topLeft  The top-left position at which to render the animation.
      */
@@ -232,26 +529,98 @@ public:
     /**
      * @brief Renders the Lottie animation on a `juce::Graphics` context with a specific transformation.
      *
+     * Only the portion of the animation inside the clip bounds of the context is rasterised.
+     *
      * @param g        The `juce::Graphics` context to render the animation on.
      * @param transform  The transformation to apply the animation rendering.
      */
     void render (juce::Graphics& g, const juce::AffineTransform& transform);
 
 private:
-    bool canRenderCurrentFrame() const;
-    void renderCurrentFrame();
+    struct PrefetchedFrame
+    {
+        int frameNumber = -1;
+        juce::Image image;
+    };
 
+    struct RenderJob
+    {
+        LottieAnimation* owner = nullptr;
+        Lottie_Animation* animation = nullptr;
+        bool ownsAnimation = false;
+        int frameNumber = -1;
+        juce::Image canvas;
+        std::unique_ptr<juce::Image::BitmapData> bitmapData;
+        std::atomic<bool> finished { false };
+    };
+
+    using PropertyOverride = std::function<juce::Result (Lottie_Animation*)>;
+
+    static void renderFinished (void* userData);
+    void handleAsyncUpdate() override;
+    bool canRenderCurrentFrame() const;
+    juce::Rectangle<int> renderCurrentFrame (const juce::Rectangle<int>& area);
+    RenderJob* getIdleRenderJob();
+    void destroyRenderJobs();
+    void submitFrame (RenderJob& job, int frameNumber);
+    bool collectRenderJob (RenderJob& job, bool waitForCompletion);
+    void collectPendingFrames (bool waitForCompletion);
+    juce::Rectangle<int> collectPreparedFrame();
+    void presentPrefetchedFrame();
+    void schedulePrefetchFrames();
+    void discardPrefetchedFrames();
+    int getPrefetchFrameNumber (int offset) const;
+    int getPrefetchFrameDistance (int frameNumber) const;
+    bool isFrameAhead (int frameNumber) const;
+    bool isFramePrefetched (int frameNumber) const;
+    bool isFrameRendering (int frameNumber) const;
+    juce::Result applyPropertyOverride (const juce::String& description, PropertyOverride propertyOverride);
+    juce::Image getSpareCanvas();
+    bool presentCachedFrame (int frameNumber);
+    bool isFrameCached (int frameNumber) const;
+    LottieFrameCache::Key getFrameCacheKey (int frameNumber) const;
+    juce::Rectangle<int> getCanvasArea (const juce::Rectangle<int>& area, const juce::AffineTransform& canvasTransform) const;
+    float getRenderScale() const;
+    void setDeviceScale (float newDeviceScale);
+    void addFrameRenderTime (double milliseconds, const juce::Rectangle<int>& renderedArea);
+    bool isTimedRenderDue();
+    bool applyRenderQuality();
+
+    juce::String modelKey;
+    LottieModelCache::ModelPtr model;
     Lottie_Animation* animation = nullptr;
 
     int originalWidth = 0;
     int originalHeight = 0;
     float scaleFactor = 1.0f;
+    float deviceScale = 1.0f;
     int lastFrame = -1;
     int currentFrame = 0;
     int numFrames = 0;
     double frameRate = 0.0;
+    RenderMode renderMode = RenderMode::Synchronous;
+    int preparingFrame = -1;
+    juce::Rectangle<int> preparingArea;
+    double preparingStartTime = 0.0;
+    int framesSinceTimedRender = 0;
+    LottieQualityGovernor::Quality renderQuality;
+    bool renderQualityChanged = false;
+    int numPrefetchFrames = 0;
+    int playbackStep = 1;
+    bool frameCachingEnabled = false;
+    juce::String frameCacheKey;
+    juce::String propertyOverridesDescription;
+    bool canvasHoldsLastRender = false;
+    juce::Rectangle<int> canvasValidArea;
 
     juce::Image canvas;
+    std::unique_ptr<juce::Image::BitmapData> preparingBitmapData;
+    std::vector<std::unique_ptr<RenderJob>> renderJobs;
+    std::vector<PrefetchedFrame> prefetchedFrames;
+    std::vector<PropertyOverride> propertyOverrides;
+    std::vector<juce::Image> spareCanvases;
+    std::unique_ptr<LottieQualityGovernor> qualityGovernor;
+    juce::ListenerList<Listener> listeners;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LottieAnimation)
 };
@@ -0,0 +1,129 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#include "jottie_LottieAnimationClock.h"
+
+namespace jottie {
+namespace {
+
+//==============================================================================
+// Ticks closer than this are coalesced, as every client gets a vblank callback from its own display.
+constexpr double minTickIntervalSeconds = 0.004;
+
+// Clients are still advanced at this rate while none of them gets vblank callbacks.
+constexpr int fallbackIntervalMs = 100;
+
+} // namespace
+
+//==============================================================================
+JUCE_IMPLEMENT_SINGLETON (LottieAnimationClock)
+
+LottieAnimationClock::~LottieAnimationClock()
+{
+    clearSingletonInstance();
+}
+
+//==============================================================================
+double LottieAnimationClock::getTime()
+{
+    return juce::Time::getMillisecondCounterHiRes() * 0.001;
+}
+
+//==============================================================================
+void LottieAnimationClock::addClient (Client& client, juce::Component& component)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (containsClient (client))
+        return;
+
+    Registration registration;
+    registration.client = std::addressof (client);
+    registration.vBlankAttachment = std::make_unique<juce::VBlankAttachment> (std::addressof (component), [this] { tick(); });
+
+    registrations.push_back (std::move (registration));
+    clients.add (std::addressof (client));
+
+    if (! isTimerRunning())
+        startTimer (fallbackIntervalMs);
+}
+
+void LottieAnimationClock::removeClient (Client& client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    auto it = std::find_if (registrations.begin(), registrations.end(), [&] (const auto& r) { return r.client == std::addressof (client); });
+    if (it == registrations.end())
+        return;
+
+    // The attachment could be the one calling us back, it is only deleted when the tick is over
+    if (isTicking)
+        detachedAttachments.push_back (std::move (it->vBlankAttachment));
+
+    registrations.erase (it);
+    clients.remove (std::addressof (client));
+
+    if (registrations.empty())
+        stopTimer();
+}
+
+bool LottieAnimationClock::containsClient (const Client& client) const
+{
+    return std::any_of (registrations.begin(), registrations.end(), [&] (const auto& r) { return r.client == std::addressof (client); });
+}
+
+//==============================================================================
+void LottieAnimationClock::tick()
+{
+    const auto now = getTime();
+    if (isTicking || now - lastTickTime < minTickIntervalSeconds)
+        return;
+
+    lastTickTime = now;
+
+    {
+        const juce::ScopedValueSetter<bool> ticking (isTicking, true);
+
+        clients.call ([now] (Client& client) { client.advanceClock (now); });
+        clients.call ([] (Client& client) { client.presentFrame(); });
+    }
+
+    detachedAttachments.clear();
+}
+
+void LottieAnimationClock::timerCallback()
+{
+    if (getTime() - lastTickTime >= fallbackIntervalMs * 0.001)
+        tick();
+}
+
+} // namespace jottie
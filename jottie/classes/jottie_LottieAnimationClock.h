@@ -0,0 +1,153 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <memory>
+#include <vector>
+
+namespace jottie {
+
+//==============================================================================
+/**
+ * @brief A process wide clock driving the playback of all the animations.
+ *
+ * Instead of each playing animation waking up on its own timer, the clients of the clock are advanced together once
+ * per display refresh, synchronised to the vertical blank of the displays their components are shown on. Every client
+ * is first asked to advance to the current time and start rasterising its next frame, then all of them present their
+ * frames, so the rendering work of all the visible animations is scheduled at once.
+ *
+ * When none of the components is on screen, the clients are still advanced at a low rate so they keep time.
+ *
+ * The clock is deleted at shutdown, before the message manager goes away, and is not recreated afterwards.
+ *
+ * @see LottieComponent
+ */
+class LottieAnimationClock : public juce::DeletedAtShutdown, private juce::Timer
+{
+public:
+    //==============================================================================
+    /**
+     * @brief The interface implemented by the objects driven by the clock.
+     */
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        /**
+         * @brief Called on every tick of the clock, before any client presents its frame.
+         *
+         * The client should work out the frame to display at the given time, and start rasterising it.
+         *
+         * @param timeInSeconds The current time of the clock, in seconds.
+         */
+        virtual void advanceClock (double timeInSeconds) = 0;
+
+        /**
+         * @brief Called on every tick of the clock, once all the clients have been advanced.
+         *
+         * The client should wait for its frame to be rasterised, and repaint.
+         */
+        virtual void presentFrame() = 0;
+    };
+
+    //==============================================================================
+    /** @internal */
+    ~LottieAnimationClock() override;
+
+    //==============================================================================
+    /**
+     * @brief Gets the clock shared by all the animations with `getInstance()`.
+     *
+     * The clock is deleted at shutdown, after which `getInstance()` returns nullptr.
+     */
+    JUCE_DECLARE_SINGLETON (LottieAnimationClock, true)
+
+    //==============================================================================
+    /**
+     * @brief Gets the current time of the clock.
+     *
+     * @return The time in seconds, from a monotonic high resolution counter.
+     */
+    static double getTime();
+
+    //==============================================================================
+    /**
+     * @brief Starts advancing a client on every display refresh, must be called on the message thread.
+     *
+     * @param client The client to advance, it must be removed before being deleted.
+     * @param component The component the client is displayed in, its display drives the refreshes.
+     */
+    void addClient (Client& client, juce::Component& component);
+
+    /**
+     * @brief Stops advancing a client, must be called on the message thread.
+     *
+     * @param client The client to remove.
+     */
+    void removeClient (Client& client);
+
+    /**
+     * @brief Checks if a client is being advanced by the clock.
+     *
+     * @param client The client to check.
+     *
+     * @return True if the client has been added to the clock.
+     */
+    bool containsClient (const Client& client) const;
+
+private:
+    struct Registration
+    {
+        Client* client = nullptr;
+        std::unique_ptr<juce::VBlankAttachment> vBlankAttachment;
+    };
+
+    LottieAnimationClock() = default;
+
+    void tick();
+    void timerCallback() override;
+
+    std::vector<Registration> registrations;
+    std::vector<std::unique_ptr<juce::VBlankAttachment>> detachedAttachments;
+    juce::ListenerList<Client> clients;
+    double lastTickTime = 0.0;
+    bool isTicking = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LottieAnimationClock)
+};
+
+} // namespace jottie
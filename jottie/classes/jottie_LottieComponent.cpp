@@ -32,7 +32,12 @@
 
 #include "jottie_LottieComponent.h"
 #include "jottie_LottieAnimation.h"
+#include "jottie_LottieAnimationClock.h"
 #include "jottie_LottieFile.h"
+#include "jottie_LottieThreadPool.h"
+
+#include <cmath>
+#include <utility>
 
 namespace jottie {
 
@@ -48,13 +53,23 @@ LottieComponent::LottieComponent (juce::StringRef componentName)
     setOpaque (true);
 }
 
+LottieComponent::~LottieComponent()
+{
+    if (auto clock = LottieAnimationClock::getInstanceWithoutCreating())
+        clock->removeClient (*this);
+
+    if (currentAnimation != nullptr)
+        currentAnimation->removeListener (this);
+}
+
 //==============================================================================
 juce::Result LottieComponent::loadAnimationJson (const juce::String& jsonString, float scaleFactor)
 {
-    currentAnimation = new LottieAnimation (jsonString);
+    LottieAnimation::Ptr animation = new LottieAnimation (jsonString);
 
-    initialiseAnimation (currentAnimation, scaleFactor);
-    
+    initialiseAnimation (animation, scaleFactor);
+
+    currentAnimation = std::move (animation);
     currentScaleFactor = scaleFactor;
 
     return currentAnimation->isValid()
@@ -72,11 +87,19 @@ juce::Result LottieComponent::loadAnimationJson (std::unique_ptr<juce::InputStre
 
 juce::Result LottieComponent::loadAnimationJson (const juce::File& jsonFile, float scaleFactor)
 {
-    auto jsonFileStream = jsonFile.createInputStream();
-    if (jsonFileStream == nullptr)
+    if (! jsonFile.existsAsFile())
         return juce::Result::fail("Unable to open json file for reading");
 
-    return loadAnimationJson (jsonFileStream->readEntireStreamAsString(), scaleFactor);
+    LottieAnimation::Ptr animation = new LottieAnimation (jsonFile);
+
+    initialiseAnimation (animation, scaleFactor);
+
+    currentAnimation = std::move (animation);
+    currentScaleFactor = scaleFactor;
+
+    return currentAnimation->isValid()
+        ? juce::Result::ok()
+        : juce::Result::fail("Error loading animation");
 }
 
 //==============================================================================
@@ -164,6 +187,82 @@ juce::Result LottieComponent::loadAnimationLottie (std::unique_ptr<juce::InputSt
     return juce::Result::ok();
 }
 
+//==============================================================================
+void LottieComponent::loadAnimationJsonAsync (const juce::String& jsonString, float scaleFactor)
+{
+    loadAnimationAsync ([jsonString]
+    {
+        AsyncLoadResult loadResult;
+
+        loadResult.animation = new LottieAnimation (jsonString);
+        // the animation is only given a size when installed on the message thread, so it can't be valid yet
+        if (! loadResult.animation->hasModel())
+            loadResult.result = juce::Result::fail ("Error loading animation");
+
+        return loadResult;
+    }, scaleFactor);
+}
+
+void LottieComponent::loadAnimationJsonAsync (const juce::File& jsonFile, float scaleFactor)
+{
+    loadAnimationAsync ([jsonFile]
+    {
+        AsyncLoadResult loadResult;
+
+        if (! jsonFile.existsAsFile())
+        {
+            loadResult.result = juce::Result::fail ("Unable to open json file for reading");
+            return loadResult;
+        }
+
+        loadResult.animation = new LottieAnimation (jsonFile);
+        // the animation is only given a size when installed on the message thread, so it can't be valid yet
+        if (! loadResult.animation->hasModel())
+            loadResult.result = juce::Result::fail ("Error loading animation");
+
+        return loadResult;
+    }, scaleFactor);
+}
+
+void LottieComponent::loadAnimationLottieAsync (const juce::File& lottieFile, float scaleFactor)
+{
+    loadAnimationAsync ([lottieFile]
+    {
+        AsyncLoadResult loadResult;
+
+        loadResult.lottieFile = LottieFile::open (lottieFile);
+        if (loadResult.lottieFile == nullptr)
+            loadResult.result = juce::Result::fail ("Unable to open lottie file for reading");
+        else if (loadResult.lottieFile->getNumAnimations() == 0)
+            loadResult.result = juce::Result::fail ("Unable to find animation in lottie file");
+        else
+            loadResult.animation = loadResult.lottieFile->loadAnimation (0);
+
+        return loadResult;
+    }, scaleFactor);
+}
+
+void LottieComponent::loadAnimationLottieAsync (const juce::File& lottieFile, juce::StringRef animationId, float scaleFactor)
+{
+    loadAnimationAsync ([lottieFile, animationId = juce::String (animationId)]
+    {
+        AsyncLoadResult loadResult;
+
+        loadResult.lottieFile = LottieFile::open (lottieFile);
+        if (loadResult.lottieFile == nullptr)
+        {
+            loadResult.result = juce::Result::fail ("Unable to open lottie file for reading");
+            return loadResult;
+        }
+
+        loadResult.animation = loadResult.lottieFile->loadAnimation (juce::StringRef (animationId));
+        if (loadResult.animation == nullptr)
+            loadResult.result = juce::Result::fail ("Unable to find animation in lottie file");
+
+        return loadResult;
+    }, scaleFactor);
+}
+
 //==============================================================================
 LottieAnimation::Ptr LottieComponent::getCurrentAnimation() const
 {
@@ -182,6 +281,7 @@ void LottieComponent::setFrameNormalised (double normalisedPosition)
 
     currentFrame = frameIndex;
 
+    restartClock();
     repaint();
 }
 
@@ -201,7 +301,11 @@ juce::RelativeTime LottieComponent::getTotalDurationTime() const
     if (currentAnimation == nullptr)
         return juce::RelativeTime::seconds (0.0);
 
-    return juce::RelativeTime::seconds (static_cast<double> (currentAnimation->getNumFrames()) * currentAnimation->getFrameRate());
+    const auto frameRate = currentAnimation->getFrameRate();
+    if (frameRate <= 0.0)
+        return juce::RelativeTime::seconds (0.0);
+
+    return juce::RelativeTime::seconds (static_cast<double> (currentAnimation->getNumFrames()) / frameRate);
 }
 
 //==============================================================================
@@ -209,13 +313,7 @@ void LottieComponent::setFrameRate(double newFrameRate)
 {
     currentFrameRate = juce::jlimit (0.0, 120.0, newFrameRate);
 
-    if (isTimerRunning())
-    {
-        if (currentFrameRate > 0.0)
-            startTimerHz (static_cast<int> (currentFrameRate));
-        else
-            stopTimer();
-    }
+    restartClock();
 }
 
 double LottieComponent::getFrameRate() const
@@ -226,6 +324,8 @@ double LottieComponent::getFrameRate() const
 void LottieComponent::resetFrameRate()
 {
     currentFrameRate = currentAnimation != nullptr ? currentAnimation->getFrameRate() : 0.0;
+
+    restartClock();
 }
 
 //==============================================================================
@@ -237,6 +337,22 @@ int LottieComponent::getDirection() const
 void LottieComponent::setDirection (int newDirection)
 {
     currentDirection = newDirection < 0 ? -1 : 1;
+
+    if (currentAnimation != nullptr)
+        currentAnimation->setPlaybackStep (currentDirection);
+
+    restartClock();
+}
+
+//==============================================================================
+void LottieComponent::setPlaybackPolicy (PlaybackPolicy newPlaybackPolicy)
+{
+    currentPlaybackPolicy = newPlaybackPolicy;
+}
+
+LottieComponent::PlaybackPolicy LottieComponent::getPlaybackPolicy() const
+{
+    return currentPlaybackPolicy;
 }
 
 //==============================================================================
@@ -245,8 +361,10 @@ juce::Result LottieComponent::play()
     if (currentAnimation == nullptr)
         return juce::Result::fail ("Invalid or not loaded animation");
     
-    if (currentFrameRate > 0.0)
-        startTimerHz (static_cast<int> (currentFrameRate));
+    restartClock();
+
+    if (auto clock = LottieAnimationClock::getInstance())
+        clock->addClient (*this, *this);
     
     listeners.call (&Listener::animationStarted, this, currentAnimation, currentFrameRate);
     
@@ -276,7 +394,9 @@ juce::Result LottieComponent::stop()
     
     listeners.call (&Listener::animationStopped, this, currentAnimation, getCurrentFrameNormalised());
     
-    stopTimer();
+    if (auto clock = LottieAnimationClock::getInstanceWithoutCreating())
+        clock->removeClient (*this);
+    needsPresentFrame = false;
     
     return juce::Result::ok();
 }
@@ -288,6 +408,8 @@ juce::Result LottieComponent::reset()
 
     currentFrame = 0;
 
+    restartClock();
+
     listeners.call (&Listener::animationReset, this, currentAnimation);
 
     repaint();
@@ -295,6 +417,62 @@ juce::Result LottieComponent::reset()
     return juce::Result::ok();
 }
 
+//==============================================================================
+void LottieComponent::setRenderMode (LottieAnimation::RenderMode newRenderMode)
+{
+    currentRenderMode = newRenderMode;
+
+    if (currentAnimation != nullptr)
+        currentAnimation->setRenderMode (currentRenderMode);
+
+    repaint();
+}
+
+LottieAnimation::RenderMode LottieComponent::getRenderMode() const
+{
+    return currentRenderMode;
+}
+
+void LottieComponent::setNumPrefetchFrames (int numFramesToPrefetch)
+{
+    currentNumPrefetchFrames = juce::jmax (0, numFramesToPrefetch);
+
+    if (currentAnimation != nullptr)
+        currentAnimation->setNumPrefetchFrames (currentNumPrefetchFrames);
+}
+
+int LottieComponent::getNumPrefetchFrames() const
+{
+    return currentNumPrefetchFrames;
+}
+
+void LottieComponent::setRenderBudget (double frameBudgetMilliseconds, int axesToDegrade)
+{
+    currentRenderBudget = juce::jmax (0.0, frameBudgetMilliseconds);
+    currentRenderBudgetAxes = axesToDegrade;
+
+    if (currentAnimation != nullptr)
+        currentAnimation->setRenderBudget (currentRenderBudget, currentRenderBudgetAxes);
+}
+
+double LottieComponent::getRenderBudget() const
+{
+    return currentRenderBudget;
+}
+
+void LottieComponent::setFrameCachingEnabled (bool shouldCacheFrames)
+{
+    currentFrameCachingEnabled = shouldCacheFrames;
+
+    if (currentAnimation != nullptr)
+        currentAnimation->setFrameCachingEnabled (currentFrameCachingEnabled);
+}
+
+bool LottieComponent::isFrameCachingEnabled() const
+{
+    return currentFrameCachingEnabled;
+}
+
 //==============================================================================
 void LottieComponent::setBackgroundColour (const juce::Colour& newBackgroundColour)
 {
@@ -334,6 +512,8 @@ void LottieComponent::paint (juce::Graphics& g)
     {
         currentAnimation->setFrame (currentFrame);
         currentAnimation->render (g, { 0, 0 });
+
+        renderedFrame = currentAnimation->getRenderedFrame();
     }
 }
 
@@ -345,27 +525,119 @@ void LottieComponent::resized()
 }
 
 //==============================================================================
-void LottieComponent::timerCallback()
+void LottieComponent::advanceClock (double timeInSeconds)
 {
-    if (currentAnimation == nullptr || currentAnimation->getNumFrames() == 0)
+    if (currentAnimation == nullptr || currentAnimation->getNumFrames() == 0 || currentFrameRate <= 0.0)
         return;
 
-    currentFrame += currentDirection;
+    const auto numFrames = currentAnimation->getNumFrames();
+
+    // the interval between the ticks is averaged, so a single late tick doesn't change the frames predicted
+    const auto tickInterval = timeInSeconds - clockLastTime;
+    clockLastTime = timeInSeconds;
+    clockTickInterval = clockTickInterval > 0.0 ? clockTickInterval + (tickInterval - clockTickInterval) * 0.1 : tickInterval;
+
+    // frames are computed from the time elapsed, so they are skipped when the display or rendering can't keep up
+    auto elapsedFrames = static_cast<int> (std::floor ((timeInSeconds - clockStartTime) * currentFrameRate));
 
-    if (currentFrame < 0)
+    // when over the render budget only one every few frames is displayed
+    const auto frameStep = juce::jmax (1, currentAnimation->getRenderQuality().frameRateDivisor);
+
+    // when slowing down, the frames that would be skipped are pushed forward in time, keeping the phase of the clock
+    if (currentPlaybackPolicy == PlaybackPolicy::SlowDown && elapsedFrames > clockElapsedFrames + frameStep)
     {
-        currentFrame = currentAnimation->getNumFrames() - 1;
+        clockStartTime += static_cast<double> (elapsedFrames - clockElapsedFrames - frameStep) / currentFrameRate;
+        elapsedFrames = clockElapsedFrames + frameStep;
+    }
+
+    elapsedFrames -= elapsedFrames % frameStep;
+
+    clockElapsedFrames = elapsedFrames;
+
+    // the frames skipped between the ticks of the clock are not going to be displayed, so they are not prefetched
+    auto playbackStep = currentPlaybackPolicy == PlaybackPolicy::SlowDown
+        ? frameStep
+        : juce::jmax (1, juce::roundToInt (clockTickInterval * currentFrameRate));
+
+    playbackStep = (playbackStep + frameStep - 1) / frameStep * frameStep;
+
+    currentAnimation->setPlaybackStep (playbackStep * currentDirection);
+
+    const auto position = clockStartFrame + elapsedFrames * currentDirection;
+    const auto loop = static_cast<int> (std::floor (static_cast<double> (position) / static_cast<double> (numFrames)));
+
+    if (loop != clockLoop)
+    {
+        clockLoop = loop;
 
         listeners.call (&Listener::animationCompleted, this, currentAnimation);
     }
-    else if (currentFrame >= currentAnimation->getNumFrames())
+
+    const auto newFrame = position - loop * numFrames;
+    if (newFrame == currentFrame)
+        return;
+
+    currentFrame = newFrame;
+    needsPresentFrame = true;
+
+    // start rasterising together with the other animations, the frame is finished when presented
+    if (isShowing())
     {
-        currentFrame = 0;
+        juce::RectangleList<int> visibleArea;
+        getVisibleArea (visibleArea, false);
 
-        listeners.call (&Listener::animationCompleted, this, currentAnimation);
+        currentAnimation->setFrame (currentFrame);
+        currentAnimation->submitCurrentFrame (visibleArea.getBounds());
     }
+}
 
-    repaint();
+void LottieComponent::presentFrame()
+{
+    if (! std::exchange (needsPresentFrame, false) || currentAnimation == nullptr)
+        return;
+
+    repaintChangedArea();
+}
+
+void LottieComponent::restartClock()
+{
+    clockStartTime = LottieAnimationClock::getTime();
+    clockLastTime = clockStartTime;
+    clockStartFrame = currentFrame;
+    clockElapsedFrames = 0;
+    clockLoop = 0;
+}
+
+void LottieComponent::repaintChangedArea()
+{
+    // the frame will be rasterised when the component is painted again
+    if (! isShowing())
+        return;
+
+    // the animation could have been rasterised by another component since this one was painted
+    const auto canRepaintPartially = currentAnimation->getRenderedFrame() == renderedFrame;
+
+    // only the portion of the component on screen is rasterised ahead of painting
+    juce::RectangleList<int> visibleArea;
+    getVisibleArea (visibleArea, false);
+
+    currentAnimation->setFrame (currentFrame);
+    const auto changedArea = currentAnimation->prepareCurrentFrame (visibleArea.getBounds());
+
+    renderedFrame = currentAnimation->getRenderedFrame();
+
+    if (! canRepaintPartially)
+        repaint();
+    else if (! changedArea.isEmpty())
+        repaint (changedArea);
+}
+
+//==============================================================================
+void LottieComponent::animationFrameReady (LottieAnimation* animation, int frameNumber)
+{
+    // frames prefetched ahead are displayed when the clock gets to them, the late ones as soon as they are ready
+    if (animation == currentAnimation.get() && animation->isFrameMoreRecent (frameNumber, renderedFrame))
+        repaint();
 }
 
 //==============================================================================
@@ -373,13 +645,78 @@ void LottieComponent::initialiseAnimation (LottieAnimation::Ptr animation, float
 {
     jassert (animation != nullptr);
 
+    // any animation installed in the component supersedes the pending background loads
+    ++asyncLoadGeneration;
+
+    // the animation could be shared with other components, only this one must stop being notified
+    if (currentAnimation != nullptr)
+        currentAnimation->removeListener (this);
+
+    animation->addListener (this);
+
     if (scaleFactor > 0.0f)
         animation->setScaleFactor (scaleFactor);
 
+    animation->setRenderMode (currentRenderMode);
+    animation->setNumPrefetchFrames (currentNumPrefetchFrames);
+    animation->setPlaybackStep (currentDirection);
+    animation->setRenderBudget (currentRenderBudget, currentRenderBudgetAxes);
+    animation->setFrameCachingEnabled (currentFrameCachingEnabled);
+
     currentFrameRate = animation->getFrameRate();
     currentFrame = 0;
 
+    restartClock();
+
     animation->setSize (getWidth(), getHeight());
 }
 
+void LottieComponent::loadAnimationAsync (std::function<AsyncLoadResult()> loadFunction, float scaleFactor)
+{
+    const auto loadGeneration = ++asyncLoadGeneration;
+
+    LottieThreadPool::getInstance().addJob ([safeThis = juce::Component::SafePointer<LottieComponent> (this),
+                                             loadFunction = std::move (loadFunction),
+                                             loadGeneration,
+                                             scaleFactor]
+    {
+        auto loadResult = loadFunction();
+
+        juce::MessageManager::callAsync ([safeThis, loadResult = std::move (loadResult), loadGeneration, scaleFactor]
+        {
+            if (auto component = safeThis.getComponent())
+                component->asyncLoadCompleted (loadGeneration, std::move (loadResult), scaleFactor);
+        });
+    });
+}
+
+void LottieComponent::asyncLoadCompleted (int loadGeneration, AsyncLoadResult loadResult, float scaleFactor)
+{
+    // a newer load was started in the meantime
+    if (loadGeneration != asyncLoadGeneration)
+        return;
+
+    if (loadResult.result.wasOk() && loadResult.animation != nullptr)
+    {
+        initialiseAnimation (loadResult.animation, scaleFactor);
+
+        if (! loadResult.animation->isValid())
+            loadResult.result = juce::Result::fail ("Error loading animation");
+
+        if (loadResult.lottieFile != nullptr)
+            currentLottieFile = std::move (loadResult.lottieFile);
+
+        currentAnimation = loadResult.animation;
+        currentScaleFactor = scaleFactor;
+
+        repaint();
+    }
+    else
+    {
+        loadResult.animation = nullptr;
+    }
+
+    listeners.call (&Listener::animationLoaded, this, loadResult.animation, loadResult.result);
+}
+
 } // namespace jottie
@@ -36,24 +36,40 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include "jottie_LottieAnimation.h"
+#include "jottie_LottieAnimationClock.h"
 #include "jottie_LottieFile.h"
 
+#include <functional>
+
 namespace jottie {
 
 //==============================================================================
 /**
  * @brief A custom JUCE Component for rendering Lottie animations.
  *
- * This class extends `juce::Component` and privately implements `juce::Timer`. It allows you to load
- * and display Lottie animations, control playback, and receive notifications about animation events. It only allows
- * to play a single lottie animation, if more animations are to be played, consider using the other class
- * `LottieMultiComponent`.
+ * This class extends `juce::Component` and privately implements `LottieAnimationClock::Client` and `LottieAnimation::Listener`.
+ * It allows you to load and display Lottie animations, control playback, and receive notifications about animation
+ * events. It only allows to play a single lottie animation, if more animations are to be played, consider using the
+ * other class `LottieMultiComponent`.
+ *
+ * While playing, the frame displayed is computed from the time elapsed on the shared `LottieAnimationClock`, which
+ * advances all the playing components together once per display refresh.
  *
- * @see LottieMultiComponent
+ * @see LottieMultiComponent, LottieAnimationClock
  */
-class LottieComponent : public juce::Component, private juce::Timer
+class LottieComponent : public juce::Component, private LottieAnimationClock::Client, private LottieAnimation::Listener
 {
 public:
+    //==============================================================================
+    /**
+     * @brief Enumerates what happens to the playback when frames can't be displayed as fast as the frame rate.
+     */
+    enum class PlaybackPolicy
+    {
+        DropFrames,         ///< Frames are skipped, so the animation keeps its timing at a lower frame rate.
+        SlowDown            ///< Frames are never skipped, so the animation slows down.
+    };
+
     //==============================================================================
     /**
      * @brief Default constructor.
@@ -67,6 +83,11 @@ public:
      */
     explicit LottieComponent (juce::StringRef componentName);
 
+    /**
+     * @brief Destructor.
+     */
+    ~LottieComponent() override;
+
     //==============================================================================
     /**
      * @brief Load a Lottie animation from JSON string.
@@ -149,6 +170,54 @@ public:
      */
     juce::Result loadAnimationLottie (std::unique_ptr<juce::InputStream> lottieFileStream, juce::StringRef animationId, float scaleFactor = 1.0f);
 
+    //==============================================================================
+    /**
+     * @brief Load a Lottie animation from JSON string in background.
+     *
+     * The animation is parsed and prepared for rendering on the `LottieThreadPool`, then it's installed in the
+     * component on the message thread and `Listener::animationLoaded` is called. If another animation is loaded
+     * before the background load completes, the result of the background load is discarded.
+     *
+     * @param jsonString The JSON string representing the animation.
+     * @param scaleFactor The scale factor for the animation (default: 1.0f).
+     *
+     * @see Listener::animationLoaded
+     */
+    void loadAnimationJsonAsync (const juce::String& jsonString, float scaleFactor = 1.0f);
+
+    /**
+     * @brief Load a Lottie animation from JSON file in background.
+     *
+     * @param jsonFile The JSON file representing the animation.
+     * @param scaleFactor The scale factor for the animation (default: 1.0f).
+     *
+     * @see loadAnimationJsonAsync, Listener::animationLoaded
+     */
+    void loadAnimationJsonAsync (const juce::File& jsonFile, float scaleFactor = 1.0f);
+
+    /**
+     * @brief Load a Lottie animation from dotLottie file in background.
+     *
+     * Only the first animation found in the dot lottie file will be used.
+     *
+     * @param lottieFile The dotLottie file representing the animation.
+     * @param scaleFactor The scale factor for the animation (default: 1.0f).
+     *
+     * @see loadAnimationJsonAsync, Listener::animationLoaded
+     */
+    void loadAnimationLottieAsync (const juce::File& lottieFile, float scaleFactor = 1.0f);
+
+    /**
+     * @brief Load a Lottie animation from dotLottie file in background.
+     *
+     * @param lottieFile The dotLottie file representing the animation.
+     * @param animationId The animation id to load from the dotLottie file.
+     * @param scaleFactor The scale factor for the animation (default: 1.0f).
+     *
+     * @see loadAnimationJsonAsync, Listener::animationLoaded
+     */
+    void loadAnimationLottieAsync (const juce::File& lottieFile, juce::StringRef animationId, float scaleFactor = 1.0f);
+
     //==============================================================================
     /**
      * @brief Set the current frame position normalized [0.0, 1.0].
@@ -176,6 +245,9 @@ public:
     /**
      * @brief Set the frame rate for the animation.
      *
+     * Frames are computed from the time elapsed since playback started, so fractional frame rates like 29.97 are
+     * played at their exact speed, regardless of the refresh rate of the display.
+     *
      * @param newFrameRate The new frame rate in frames per second.
      */
     void setFrameRate(double newFrameRate);
@@ -207,6 +279,25 @@ public:
      */
     void setDirection (int newDirection);
 
+    //==============================================================================
+    /**
+     * @brief Set what happens to the playback when frames can't be displayed as fast as the frame rate.
+     *
+     * This happens when the display refreshes slower than the frame rate, or when rendering is too slow to keep up
+     * with it. The default `PlaybackPolicy::DropFrames` keeps the perceived timing of the animation and bounds the
+     * amount of frames rendered per second, `PlaybackPolicy::SlowDown` advances at most one frame per refresh.
+     *
+     * @param newPlaybackPolicy The new playback policy.
+     */
+    void setPlaybackPolicy (PlaybackPolicy newPlaybackPolicy);
+
+    /**
+     * @brief Get what happens to the playback when frames can't be displayed as fast as the frame rate.
+     *
+     * @return The current playback policy.
+     */
+    PlaybackPolicy getPlaybackPolicy() const;
+
     //==============================================================================
     /**
      * @brief Start playing the animation.
@@ -224,6 +315,86 @@ public:
      */
     juce::Result reset();
 
+    //==============================================================================
+    /**
+     * @brief Set how the frames of the animations loaded in the component are rasterised.
+     *
+     * When using `LottieAnimation::RenderMode::Asynchronous`, the component listens to the animation and repaints
+     * itself when it's notified that a frame rasterised in background is ready, and more recent than the one it
+     * displays. It doesn't repaint while waiting for the frames.
+     *
+     * @param newRenderMode The new render mode.
+     *
+     * @see LottieAnimation::setRenderMode
+     */
+    void setRenderMode (LottieAnimation::RenderMode newRenderMode);
+
+    /**
+     * @brief Get the render mode used by the animations loaded in the component.
+     *
+     * @return The current render mode.
+     */
+    LottieAnimation::RenderMode getRenderMode() const;
+
+    /**
+     * @brief Set the number of frames to rasterise ahead of the current one when rendering asynchronously.
+     *
+     * The frames to prefetch are predicted from the playback direction and the frames skipped between the ticks of
+     * the clock, and up to that many of them are rasterised at once.
+     *
+     * @param numFramesToPrefetch The number of frames to prefetch, 0 disables the prefetching.
+     *
+     * @see LottieAnimation::setNumPrefetchFrames
+     */
+    void setNumPrefetchFrames (int numFramesToPrefetch);
+
+    /**
+     * @brief Get the number of frames rasterised ahead of the current one when rendering asynchronously.
+     *
+     * @return The number of frames to prefetch.
+     */
+    int getNumPrefetchFrames() const;
+
+    /**
+     * @brief Set a budget for the time taken to rasterise a frame of the animations loaded in the component.
+     *
+     * When frames take longer than the budget, their quality is degraded along the given axes until they fit, and
+     * restored once there is enough headroom again. When degrading the frame rate, the component only displays one
+     * every few frames of the animation.
+     *
+     * @param frameBudgetMilliseconds The time a frame should take to be rasterised at most, 0 disables the budget.
+     * @param axesToDegrade The combination of `LottieQualityGovernor::Axis` flags the quality can be degraded along.
+     *
+     * @see LottieAnimation::setRenderBudget
+     */
+    void setRenderBudget (double frameBudgetMilliseconds, int axesToDegrade = LottieQualityGovernor::AllAxes);
+
+    /**
+     * @brief Get the budget for the time taken to rasterise a frame of the animations loaded in the component.
+     *
+     * @return The budget in milliseconds, 0 if the budget is disabled.
+     */
+    double getRenderBudget() const;
+
+    /**
+     * @brief Set whether the frames of the animations loaded in the component are cached once rendered.
+     *
+     * The frames are kept in the process wide `LottieFrameCache`, shared with the other animations with the same
+     * content, so they are still available when the animation is loaded again.
+     *
+     * @param shouldCacheFrames True to cache the rendered frames.
+     *
+     * @see LottieAnimation::setFrameCachingEnabled
+     */
+    void setFrameCachingEnabled (bool shouldCacheFrames);
+
+    /**
+     * @brief Check whether the frames of the animations loaded in the component are cached once rendered.
+     *
+     * @return True if the frame caching is enabled.
+     */
+    bool isFrameCachingEnabled() const;
+
     //==============================================================================
     /**
      * @brief Set the background color of the component.
@@ -248,6 +419,20 @@ public:
     public:
         virtual ~Listener() = default;
 
+        /**
+         * @brief Called when an animation loaded in background is ready, or failed to load.
+         *
+         * When the load succeeded the animation is already the current animation of the component.
+         *
+         * @param source The source LottieComponent.
+         * @param animation The loaded animation, nullptr if the load failed.
+         * @param result The result of the loading operation.
+         */
+        virtual void animationLoaded (LottieComponent* source, LottieAnimation::Ptr animation, const juce::Result& result)
+        {
+            juce::ignoreUnused (source, animation, result);
+        }
+
         /**
          * @brief Called when the animation starts playing.
          *
@@ -323,9 +508,22 @@ public:
     void resized() override;
 
 private:
-    void timerCallback() override;
+    void advanceClock (double timeInSeconds) override;
+    void presentFrame() override;
+    void animationFrameReady (LottieAnimation* animation, int frameNumber) override;
+    void restartClock();
+    void repaintChangedArea();
+
+    struct AsyncLoadResult
+    {
+        juce::Result result = juce::Result::ok();
+        LottieAnimation::Ptr animation;
+        LottieFile::Ptr lottieFile;
+    };
 
     void initialiseAnimation (LottieAnimation::Ptr animation, float scaleFactor);
+    void loadAnimationAsync (std::function<AsyncLoadResult()> loadFunction, float scaleFactor);
+    void asyncLoadCompleted (int loadGeneration, AsyncLoadResult loadResult, float scaleFactor);
 
     LottieAnimation::Ptr currentAnimation;
     LottieFile::Ptr currentLottieFile;
@@ -333,8 +531,23 @@ private:
     juce::Colour backgroundColour = juce::Colours::black;
     float currentScaleFactor = 1.0f;
     int currentFrame = 0;
+    int renderedFrame = -1;
     double currentFrameRate = 0.0;
     int currentDirection = 1;
+    PlaybackPolicy currentPlaybackPolicy = PlaybackPolicy::DropFrames;
+    double clockStartTime = 0.0;
+    double clockLastTime = 0.0;
+    double clockTickInterval = 0.0;
+    int clockStartFrame = 0;
+    int clockElapsedFrames = 0;
+    int clockLoop = 0;
+    bool needsPresentFrame = false;
+    LottieAnimation::RenderMode currentRenderMode = LottieAnimation::RenderMode::Synchronous;
+    int currentNumPrefetchFrames = 0;
+    double currentRenderBudget = 0.0;
+    int currentRenderBudgetAxes = LottieQualityGovernor::AllAxes;
+    bool currentFrameCachingEnabled = false;
+    int asyncLoadGeneration = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LottieComponent)
 };
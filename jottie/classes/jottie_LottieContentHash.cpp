@@ -0,0 +1,196 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#include "jottie_LottieContentHash.h"
+
+#include <cstring>
+
+namespace jottie {
+namespace {
+
+//==============================================================================
+constexpr juce::uint64 prime1 = 0x9e3779b185ebca87ull;
+constexpr juce::uint64 prime2 = 0xc2b2ae3d27d4eb4full;
+constexpr juce::uint64 prime3 = 0x165667b19e3779f9ull;
+constexpr juce::uint64 prime4 = 0x85ebca77c2b2ae63ull;
+constexpr juce::uint64 prime5 = 0x27d4eb2f165667c5ull;
+
+constexpr juce::uint64 lowSeed = 0;
+constexpr juce::uint64 highSeed = 0x6a09e667f3bcc909ull;
+
+inline juce::uint64 rotateLeft (juce::uint64 value, int bits) noexcept
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline juce::uint64 read64 (const juce::uint8* data) noexcept
+{
+    juce::uint64 value;
+    std::memcpy (&value, data, sizeof (value));
+    return juce::ByteOrder::swapIfBigEndian (value);
+}
+
+inline juce::uint32 read32 (const juce::uint8* data) noexcept
+{
+    juce::uint32 value;
+    std::memcpy (&value, data, sizeof (value));
+    return juce::ByteOrder::swapIfBigEndian (value);
+}
+
+inline juce::uint64 accumulate (juce::uint64 accumulator, juce::uint64 input) noexcept
+{
+    accumulator += input * prime2;
+    accumulator = rotateLeft (accumulator, 31);
+    return accumulator * prime1;
+}
+
+inline juce::uint64 mergeRound (juce::uint64 accumulator, juce::uint64 value) noexcept
+{
+    accumulator ^= accumulate (0, value);
+    return accumulator * prime1 + prime4;
+}
+
+//==============================================================================
+/*
+ * The state of one xxHash64 lane set. Two of these are advanced over the same stripes to produce 128 bits, so the
+ * data is read from memory only once.
+ */
+struct HashState
+{
+    explicit HashState (juce::uint64 initialSeed) noexcept
+        : seed (initialSeed)
+        , v1 (initialSeed + prime1 + prime2)
+        , v2 (initialSeed + prime2)
+        , v3 (initialSeed)
+        , v4 (initialSeed - prime1)
+    {
+    }
+
+    inline void consumeStripe (juce::uint64 w1, juce::uint64 w2, juce::uint64 w3, juce::uint64 w4) noexcept
+    {
+        v1 = accumulate (v1, w1);
+        v2 = accumulate (v2, w2);
+        v3 = accumulate (v3, w3);
+        v4 = accumulate (v4, w4);
+    }
+
+    juce::uint64 finalise (const juce::uint8* tail, std::size_t tailBytes, std::size_t totalBytes, bool hasStripes) const noexcept
+    {
+        juce::uint64 hash;
+
+        if (hasStripes)
+        {
+            hash = rotateLeft (v1, 1) + rotateLeft (v2, 7) + rotateLeft (v3, 12) + rotateLeft (v4, 18);
+            hash = mergeRound (hash, v1);
+            hash = mergeRound (hash, v2);
+            hash = mergeRound (hash, v3);
+            hash = mergeRound (hash, v4);
+        }
+        else
+        {
+            hash = seed + prime5;
+        }
+
+        hash += static_cast<juce::uint64> (totalBytes);
+
+        for (; tailBytes >= 8; tailBytes -= 8, tail += 8)
+            hash = rotateLeft (hash ^ accumulate (0, read64 (tail)), 27) * prime1 + prime4;
+
+        if (tailBytes >= 4)
+        {
+            hash = rotateLeft (hash ^ (static_cast<juce::uint64> (read32 (tail)) * prime1), 23) * prime2 + prime3;
+            tail += 4;
+            tailBytes -= 4;
+        }
+
+        for (; tailBytes > 0; --tailBytes, ++tail)
+            hash = rotateLeft (hash ^ (*tail * prime5), 11) * prime1;
+
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+    juce::uint64 seed, v1, v2, v3, v4;
+};
+
+} // namespace
+
+//==============================================================================
+LottieContentHash LottieContentHash::compute (const void* data, std::size_t numBytes) noexcept
+{
+    const auto* bytes = static_cast<const juce::uint8*> (data);
+    const auto* end = bytes + numBytes;
+
+    HashState lowState (lowSeed);
+    HashState highState (highSeed);
+
+    const bool hasStripes = numBytes >= 32;
+
+    for (; end - bytes >= 32; bytes += 32)
+    {
+        const auto w1 = read64 (bytes);
+        const auto w2 = read64 (bytes + 8);
+        const auto w3 = read64 (bytes + 16);
+        const auto w4 = read64 (bytes + 24);
+
+        lowState.consumeStripe (w1, w2, w3, w4);
+        highState.consumeStripe (w1, w2, w3, w4);
+    }
+
+    const auto tailBytes = static_cast<std::size_t> (end - bytes);
+
+    LottieContentHash result;
+    result.low = lowState.finalise (bytes, tailBytes, numBytes, hasStripes);
+    result.high = highState.finalise (bytes, tailBytes, numBytes, hasStripes);
+    result.size = static_cast<juce::uint64> (numBytes);
+    return result;
+}
+
+LottieContentHash LottieContentHash::compute (const juce::String& text) noexcept
+{
+    return compute (text.toRawUTF8(), text.getNumBytesAsUTF8());
+}
+
+//==============================================================================
+juce::String LottieContentHash::toString() const
+{
+    return juce::String::toHexString (static_cast<juce::int64> (high)).paddedLeft ('0', 16)
+         + juce::String::toHexString (static_cast<juce::int64> (low)).paddedLeft ('0', 16)
+         + ":" + juce::String (static_cast<juce::int64> (size));
+}
+
+} // namespace jottie
@@ -0,0 +1,97 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace jottie {
+
+//==============================================================================
+/**
+ * @brief A 128 bit non cryptographic hash of Lottie animation data.
+ *
+ * The `LottieContentHash` is used to identify animation data in the caches. It's computed with a variant of xxHash64
+ * running two independently seeded lanes over the data in a single pass, which is fast enough to hash multi megabyte
+ * payloads at memory bandwidth while making accidental collisions practically impossible.
+ *
+ * Compute it once when the data is created or loaded, and pass it along with the data to avoid hashing it again.
+ *
+ * @see LottieAnimation, LottieModelCache
+ */
+struct LottieContentHash
+{
+    juce::uint64 low = 0;
+    juce::uint64 high = 0;
+    juce::uint64 size = 0;
+
+    //==============================================================================
+    /**
+     * @brief Computes the hash of a block of memory.
+     *
+     * @param data The data to hash.
+     * @param numBytes The size of the data in bytes.
+     *
+     * @return The hash of the data.
+     */
+    static LottieContentHash compute (const void* data, std::size_t numBytes) noexcept;
+
+    /**
+     * @brief Computes the hash of the UTF-8 representation of a string, without copying it.
+     *
+     * @param text The string to hash.
+     *
+     * @return The hash of the string.
+     */
+    static LottieContentHash compute (const juce::String& text) noexcept;
+
+    //==============================================================================
+    /**
+     * @brief Returns the hash as an hexadecimal string, suitable to be used as cache key.
+     *
+     * @return The hash as string.
+     */
+    juce::String toString() const;
+
+    //==============================================================================
+    bool operator== (const LottieContentHash& other) const noexcept
+    {
+        return low == other.low && high == other.high && size == other.size;
+    }
+
+    bool operator!= (const LottieContentHash& other) const noexcept
+    {
+        return ! operator== (other);
+    }
+};
+
+} // namespace jottie
@@ -31,6 +31,12 @@
  */
 
 #include "jottie_LottieFile.h"
+#include "jottie_LottieThreadPool.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace jottie {
 namespace {
@@ -152,32 +158,18 @@ LottieAnimation::Ptr LottieFile::loadAnimation (int index)
 
 LottieAnimation::Ptr LottieFile::loadAnimation (juce::StringRef animationId)
 {
-    auto it = cachedAnimations.find (animationId);
-    if (it != cachedAnimations.end())
-        return it->second;
-
-    if (lottieZip == nullptr)
-        lottieZip = openZipFile();
-
-    if (lottieZip == nullptr || ! animationIds.contains (animationId))
-        return {};
-
-    juce::String animationPath;
-    animationPath << "animations/" << animationId << ".json";
+    {
+        const juce::ScopedLock sl (cacheLock);
 
-    auto animationEntry = lottieZip->getEntry (animationPath);
-    if (animationEntry == nullptr)
-        return {};
+        auto it = cachedAnimations.find (animationId);
+        if (it != cachedAnimations.end())
+            return it->second;
+    }
 
-    std::unique_ptr<juce::InputStream> animationStream (lottieZip->createStreamForEntry (*animationEntry));
-    if (animationStream == nullptr)
+    if (! animationIds.contains (animationId))
         return {};
 
-    LottieAnimation::Ptr animation = new LottieAnimation (animationStream->readEntireStreamAsString());
-
-    cachedAnimations[animationId] = animation;
-
-    return animation;
+    return createAnimation (animationId);
 }
 
 void LottieFile::loadAllAnimations()
@@ -186,17 +178,156 @@ void LottieFile::loadAllAnimations()
         loadAnimation (juce::StringRef (animationId));
 }
 
+void LottieFile::loadAllAnimationsInParallel()
+{
+    juce::StringArray animationIdsToLoad;
+
+    {
+        const juce::ScopedLock sl (cacheLock);
+
+        for (const auto& animationId : animationIds)
+            if (cachedAnimations.find (animationId) == cachedAnimations.end())
+                animationIdsToLoad.add (animationId);
+    }
+
+    // the zip entries can't be read concurrently, so they are read here and only the parsing happens in parallel
+    std::vector<std::pair<juce::String, juce::String>> animationsToParse;
+
+    for (const auto& animationId : animationIdsToLoad)
+    {
+        const auto animationHash = getContentHash (animationId);
+
+        if (animationHash.size != 0 && LottieAnimation::isModelCached (animationHash))
+        {
+            createAnimation (juce::StringRef (animationId));
+            continue;
+        }
+
+        auto animationData = readAnimationData (animationId);
+        if (animationData.isNotEmpty())
+            animationsToParse.emplace_back (animationId, std::move (animationData));
+    }
+
+    if (animationsToParse.empty())
+        return;
+
+    // the jobs could start after this returns, once the animations have all been parsed by someone else
+    struct ParseState
+    {
+        std::vector<std::pair<juce::String, juce::String>> animations;
+        std::atomic<std::size_t> nextAnimation { 0 };
+        std::atomic<std::size_t> numParsed { 0 };
+        juce::WaitableEvent allParsed;
+    };
+
+    auto state = std::make_shared<ParseState>();
+    state->animations = std::move (animationsToParse);
+
+    auto parseNextAnimation = [this, state]
+    {
+        const auto index = state->nextAnimation++;
+        if (index >= state->animations.size())
+            return false;
+
+        const auto& animationToParse = state->animations[index];
+        createAnimation (juce::StringRef (animationToParse.first), animationToParse.second);
+
+        if (++state->numParsed == state->animations.size())
+            state->allParsed.signal();
+
+        return true;
+    };
+
+    for (std::size_t i = 1; i < state->animations.size(); ++i)
+        LottieThreadPool::getInstance().addJob ([parseNextAnimation] { parseNextAnimation(); });
+
+    // the calling thread parses the animations not taken by the pool yet instead of waiting for it, so this can't
+    // deadlock when called from a job running on the pool, or when the whole pool is busy in here
+    while (parseNextAnimation())
+        ;
+
+    state->allParsed.wait();
+}
+
 //==============================================================================
 void LottieFile::clearAnimation (juce::StringRef animationId)
 {
+    const juce::ScopedLock sl (cacheLock);
+
     cachedAnimations.erase (animationId);
 }
 
 void LottieFile::clearAllAnimations()
 {
+    const juce::ScopedLock sl (cacheLock);
+
     cachedAnimations.clear();
 }
 
+//==============================================================================
+LottieAnimation::Ptr LottieFile::createAnimation (juce::StringRef animationId)
+{
+    const auto animationHash = getContentHash (animationId);
+
+    if (animationHash.size == 0)
+        return createAnimation (animationId, readAnimationData (animationId));
+
+    // the animation was loaded before, it's only read again if its model has been evicted from the cache
+    LottieAnimation::Ptr animation = new LottieAnimation (animationHash, [this, animationId] { return readAnimationData (animationId); });
+
+    const juce::ScopedLock sl (cacheLock);
+
+    // another thread might have loaded the same animation in the meantime
+    return cachedAnimations.emplace (animationId, animation).first->second;
+}
+
+LottieAnimation::Ptr LottieFile::createAnimation (juce::StringRef animationId, const juce::String& animationData)
+{
+    if (animationData.isEmpty())
+        return {};
+
+    const auto animationHash = LottieContentHash::compute (animationData);
+
+    LottieAnimation::Ptr animation = new LottieAnimation (animationData, animationHash);
+
+    const juce::ScopedLock sl (cacheLock);
+
+    contentHashes[animationId] = animationHash;
+
+    // another thread might have loaded the same animation in the meantime
+    return cachedAnimations.emplace (animationId, animation).first->second;
+}
+
+LottieContentHash LottieFile::getContentHash (juce::StringRef animationId) const
+{
+    const juce::ScopedLock sl (cacheLock);
+
+    auto it = contentHashes.find (animationId);
+    return it != contentHashes.end() ? it->second : LottieContentHash();
+}
+
+juce::String LottieFile::readAnimationData (juce::StringRef animationId)
+{
+    if (lottieZip == nullptr)
+        lottieZip = openZipFile();
+
+    if (lottieZip == nullptr)
+        return {};
+
+    juce::String animationPath;
+    animationPath << "animations/" << animationId << ".json";
+
+    auto animationEntry = lottieZip->getEntry (animationPath);
+    if (animationEntry == nullptr)
+        return {};
+
+    std::unique_ptr<juce::InputStream> animationStream (lottieZip->createStreamForEntry (*animationEntry));
+    if (animationStream == nullptr)
+        return {};
+
+    return animationStream->readEntireStreamAsString();
+}
+
 //==============================================================================
 std::unique_ptr<juce::ZipFile> LottieFile::openZipFile()
 {
@@ -109,6 +109,8 @@ public:
      *
      * If the animation was previously loaded and it's currently in the internal cache, it will be returned instead of
      * being loaded again from the Lottie file.
+     * Once cleared from the internal cache, the animation is only read again from the Lottie file when its parsed
+     * model is not in the `LottieModelCache` anymore.
      *
      * @param index The index of the animation to load.
      *
@@ -121,6 +123,8 @@ public:
      *
      * If the animation was previously loaded and it's currently in the internal cache, it will be returned instead of
      * being loaded again from the Lottie file.
+     * Once cleared from the internal cache, the animation is only read again from the Lottie file when its parsed
+     * model is not in the `LottieModelCache` anymore.
      *
      * @param animationId The ID of the animation to load.
      *
@@ -133,6 +137,18 @@ public:
      */
     void loadAllAnimations();
 
+    /**
+     * @brief Load all animations concurrently and put them in the cache.
+     *
+     * The animations are read from the archive one after the other on the calling thread, as the archive can't be read
+     * concurrently, and then parsed in parallel on the `LottieThreadPool`. Animations whose parsed model is still in
+     * the `LottieModelCache` are not read at all. This call blocks until all of them are loaded, the calling thread
+     * parses the animations the pool didn't get to yet, so it can also be called from a job running on the pool.
+     *
+     * @see LottieThreadPool
+     */
+    void loadAllAnimationsInParallel();
+
     //==============================================================================
     /**
      * @brief Clear a specific cached animation by animation ID.
@@ -156,12 +172,18 @@ private:
                 juce::StringArray animationIds);
 
     std::unique_ptr<juce::ZipFile> openZipFile();
+    LottieAnimation::Ptr createAnimation (juce::StringRef animationId);
+    LottieAnimation::Ptr createAnimation (juce::StringRef animationId, const juce::String& animationData);
+    LottieContentHash getContentHash (juce::StringRef animationId) const;
+    juce::String readAnimationData (juce::StringRef animationId);
 
     juce::File lottieFile;
     std::unique_ptr<juce::InputStream> lottieStream;
     std::unique_ptr<juce::ZipFile> lottieZip;
     juce::StringArray animationIds;
     std::unordered_map<juce::String, LottieAnimation::Ptr> cachedAnimations;
+    std::unordered_map<juce::String, LottieContentHash> contentHashes;
+    juce::CriticalSection cacheLock;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LottieFile)
 };
@@ -0,0 +1,401 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#include "jottie_LottieFrameCache.h"
+
+#include <cstring>
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define JOTTIE_FRAME_CACHE_USE_NEON 1
+#endif
+
+namespace jottie {
+namespace {
+
+//==============================================================================
+/*
+ * Encoded frames are a sequence of runs per scanline, a run never spans multiple scanlines. Each run starts with an
+ * header word, where the lower 31 bits are the number of pixels and the top bit tells if the run is a literal. A
+ * literal run is followed by its pixels, a repeat run is followed by the single pixel to repeat.
+ */
+constexpr juce::uint32 literalRunFlag = 0x80000000u;
+constexpr juce::uint32 runLengthMask = 0x7fffffffu;
+constexpr int minRepeatRunLength = 3;
+
+std::size_t getImageSizeInBytes (const juce::Image& image)
+{
+    return static_cast<std::size_t> (image.getWidth()) * static_cast<std::size_t> (image.getHeight()) * sizeof (juce::uint32);
+}
+
+int getRepeatRunLength (const juce::uint32* pixels, int numPixels, int maxLength)
+{
+    const auto limit = juce::jmin (numPixels, maxLength);
+    const auto value = pixels[0];
+
+    int length = 1;
+    while (length < limit && pixels[length] == value)
+        ++length;
+
+    return length;
+}
+
+void encodeScanline (const juce::uint32* pixels, int width, std::vector<juce::uint32>& encodedPixels)
+{
+    int x = 0;
+    while (x < width)
+    {
+        const auto repeatLength = getRepeatRunLength (pixels + x, width - x, width);
+        if (repeatLength >= minRepeatRunLength)
+        {
+            encodedPixels.push_back (static_cast<juce::uint32> (repeatLength));
+            encodedPixels.push_back (pixels[x]);
+
+            x += repeatLength;
+            continue;
+        }
+
+        const auto literalStart = x;
+        x += repeatLength;
+
+        while (x < width)
+        {
+            const auto length = getRepeatRunLength (pixels + x, width - x, minRepeatRunLength);
+            if (length >= minRepeatRunLength)
+                break;
+
+            x += length;
+        }
+
+        encodedPixels.push_back (static_cast<juce::uint32> (x - literalStart) | literalRunFlag);
+        encodedPixels.insert (encodedPixels.end(), pixels + literalStart, pixels + x);
+    }
+}
+
+bool encodeImage (const juce::Image& image, std::vector<juce::uint32>& encodedPixels)
+{
+    const juce::Image::BitmapData bitmapData (image, juce::Image::BitmapData::readOnly);
+
+    if (bitmapData.pixelStride != static_cast<int> (sizeof (juce::uint32)))
+        return false;
+
+    const auto maxEncodedSize = static_cast<std::size_t> (bitmapData.width) * static_cast<std::size_t> (bitmapData.height);
+
+    encodedPixels.clear();
+
+    for (int y = 0; y < bitmapData.height; ++y)
+    {
+        encodeScanline (reinterpret_cast<const juce::uint32*> (bitmapData.getLinePointer (y)), bitmapData.width, encodedPixels);
+
+        // give up as soon as the frame doesn't compress
+        if (encodedPixels.size() >= maxEncodedSize)
+            return false;
+    }
+
+    encodedPixels.shrink_to_fit();
+    return true;
+}
+
+void fillPixels (juce::uint32* destination, juce::uint32 value, int numPixels)
+{
+#if JUCE_INTEL
+    const auto vectorValue = _mm_set1_epi32 (static_cast<int> (value));
+
+    for (; numPixels >= 8; numPixels -= 8, destination += 8)
+    {
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (destination), vectorValue);
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (destination + 4), vectorValue);
+    }
+
+    for (; numPixels >= 4; numPixels -= 4, destination += 4)
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (destination), vectorValue);
+#elif JOTTIE_FRAME_CACHE_USE_NEON
+    const auto vectorValue = vdupq_n_u32 (value);
+
+    for (; numPixels >= 8; numPixels -= 8, destination += 8)
+    {
+        vst1q_u32 (destination, vectorValue);
+        vst1q_u32 (destination + 4, vectorValue);
+    }
+
+    for (; numPixels >= 4; numPixels -= 4, destination += 4)
+        vst1q_u32 (destination, vectorValue);
+#endif
+
+    while (--numPixels >= 0)
+        *destination++ = value;
+}
+
+void decodeImage (const std::vector<juce::uint32>& encodedPixels, juce::Image& image)
+{
+    juce::Image::BitmapData bitmapData (image, juce::Image::BitmapData::writeOnly);
+
+    const auto* source = encodedPixels.data();
+    const auto* sourceEnd = source + encodedPixels.size();
+
+    for (int y = 0; y < bitmapData.height && source < sourceEnd; ++y)
+    {
+        auto* destination = reinterpret_cast<juce::uint32*> (bitmapData.getLinePointer (y));
+
+        for (int x = 0; x < bitmapData.width && source < sourceEnd;)
+        {
+            const auto header = *source++;
+            const auto length = static_cast<int> (header & runLengthMask);
+
+            if ((header & literalRunFlag) != 0)
+            {
+                std::memcpy (destination + x, source, static_cast<std::size_t> (length) * sizeof (juce::uint32));
+                source += length;
+            }
+            else
+            {
+                fillPixels (destination + x, *source++, length);
+            }
+
+            x += length;
+        }
+    }
+}
+
+} // namespace
+
+//==============================================================================
+std::size_t LottieFrameCache::KeyHash::operator() (const Key& key) const noexcept
+{
+    auto hash = static_cast<std::size_t> (key.animationKey.hashCode64());
+    hash = hash * 31u + static_cast<std::size_t> (key.frameNumber);
+    hash = hash * 31u + static_cast<std::size_t> (key.width);
+    hash = hash * 31u + static_cast<std::size_t> (key.height);
+    hash = hash * 31u + static_cast<std::size_t> (key.antiAliasing ? 1 : 0);
+    return hash;
+}
+
+//==============================================================================
+JUCE_IMPLEMENT_SINGLETON (LottieFrameCache)
+
+LottieFrameCache::LottieFrameCache (std::size_t maxSizeInBytes, Compression newCompression)
+    : maxSize (maxSizeInBytes)
+    , compression (newCompression)
+{
+}
+
+LottieFrameCache::LottieFrameCache()
+    : LottieFrameCache (static_cast<std::size_t> (JOTTIE_FRAME_CACHE_SIZE))
+{
+}
+
+LottieFrameCache::~LottieFrameCache()
+{
+    clearSingletonInstance();
+}
+
+//==============================================================================
+void LottieFrameCache::setMaximumSize (std::size_t newMaxSizeInBytes)
+{
+    const juce::ScopedLock sl (lock);
+
+    maxSize = newMaxSizeInBytes;
+
+    evictFramesToFit (0);
+}
+
+std::size_t LottieFrameCache::getMaximumSize() const
+{
+    const juce::ScopedLock sl (lock);
+
+    return maxSize;
+}
+
+void LottieFrameCache::setCompression (Compression newCompression)
+{
+    const juce::ScopedLock sl (lock);
+
+    if (compression == newCompression)
+        return;
+
+    compression = newCompression;
+
+    lookup.clear();
+    entries.clear();
+
+    currentSize = 0;
+}
+
+LottieFrameCache::Compression LottieFrameCache::getCompression() const
+{
+    const juce::ScopedLock sl (lock);
+
+    return compression;
+}
+
+std::size_t LottieFrameCache::getCurrentSize() const
+{
+    const juce::ScopedLock sl (lock);
+
+    return currentSize;
+}
+
+int LottieFrameCache::getNumFrames() const
+{
+    const juce::ScopedLock sl (lock);
+
+    return static_cast<int> (entries.size());
+}
+
+//==============================================================================
+bool LottieFrameCache::getFrame (const Key& key, juce::Image& image)
+{
+    std::shared_ptr<const std::vector<juce::uint32>> encodedPixels;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        auto it = lookup.find (key);
+        if (it == lookup.end())
+            return false;
+
+        entries.splice (entries.begin(), entries, it->second);
+
+        const auto& entry = *it->second;
+        if (entry.image.isValid())
+        {
+            image = entry.image;
+            return true;
+        }
+
+        // the runs are kept alive by the pointer if the frame is evicted meanwhile
+        encodedPixels = entry.encodedPixels;
+    }
+
+    // the frame is decoded outside of the lock, so the other animations using the cache are not held up by it
+    if (image.getWidth() != key.width || image.getHeight() != key.height || image.getReferenceCount() > 1)
+        image = juce::Image (juce::Image::ARGB, key.width, key.height, false);
+
+    decodeImage (*encodedPixels, image);
+    return true;
+}
+
+bool LottieFrameCache::containsFrame (const Key& key) const
+{
+    const juce::ScopedLock sl (lock);
+
+    return lookup.find (key) != lookup.end();
+}
+
+void LottieFrameCache::addFrame (const Key& key, const juce::Image& image)
+{
+    if (! image.isValid())
+        return;
+
+    Entry entry { key, {}, {}, 0 };
+    std::vector<juce::uint32> encodedPixels;
+
+    if (getCompression() == Compression::RunLength && encodeImage (image, encodedPixels))
+    {
+        entry.sizeInBytes = encodedPixels.size() * sizeof (juce::uint32);
+        entry.encodedPixels = std::make_shared<const std::vector<juce::uint32>> (std::move (encodedPixels));
+    }
+    else
+    {
+        entry.image = image;
+        entry.sizeInBytes = getImageSizeInBytes (image);
+    }
+
+    const auto sizeInBytes = entry.sizeInBytes;
+
+    const juce::ScopedLock sl (lock);
+
+    if (auto it = lookup.find (key); it != lookup.end())
+    {
+        currentSize -= it->second->sizeInBytes;
+
+        entries.erase (it->second);
+        lookup.erase (it);
+    }
+
+    if (sizeInBytes > maxSize)
+        return;
+
+    evictFramesToFit (sizeInBytes);
+
+    entries.push_front (std::move (entry));
+    lookup[key] = entries.begin();
+
+    currentSize += sizeInBytes;
+}
+
+void LottieFrameCache::removeFrames (const juce::String& animationKey)
+{
+    const juce::ScopedLock sl (lock);
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->key.animationKey != animationKey)
+        {
+            ++it;
+            continue;
+        }
+
+        currentSize -= it->sizeInBytes;
+
+        lookup.erase (it->key);
+        it = entries.erase (it);
+    }
+}
+
+void LottieFrameCache::clear()
+{
+    const juce::ScopedLock sl (lock);
+
+    lookup.clear();
+    entries.clear();
+
+    currentSize = 0;
+}
+
+//==============================================================================
+void LottieFrameCache::evictFramesToFit (std::size_t sizeInBytes)
+{
+    while (! entries.empty() && currentSize + sizeInBytes > maxSize)
+    {
+        auto& entry = entries.back();
+
+        currentSize -= entry.sizeInBytes;
+
+        lookup.erase (entry.key);
+        entries.pop_back();
+    }
+}
+
+} // namespace jottie
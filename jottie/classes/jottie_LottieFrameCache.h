@@ -0,0 +1,236 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace jottie {
+
+//==============================================================================
+/**
+ * @brief A memory bounded cache of rendered Lottie animation frames.
+ *
+ * The `LottieFrameCache` class stores the rasterised frames of animations, so frames that are displayed over and
+ * over (like in looping animations) are rendered only once. When adding a frame would exceed the maximum size in
+ * bytes, the least recently used frames are evicted from the cache.
+ *
+ * The animations share a process wide instance, where frames are keyed by the content of the animation rather than
+ * by the instance rendering them: the frames survive the animation being loaded again, and are shared by all the
+ * animations displaying the same content at the same size.
+ *
+ * Frames can optionally be stored run-length encoded: as most Lottie frames are largely transparent or made of flat
+ * colours, this usually reduces the memory used by an order of magnitude, at the cost of decoding the frame when
+ * it's retrieved from the cache.
+ *
+ * @see LottieAnimation
+ */
+class LottieFrameCache : public juce::DeletedAtShutdown
+{
+public:
+    //==============================================================================
+    /**
+     * @brief Identifies a rendered frame in the cache.
+     */
+    struct Key
+    {
+        juce::String animationKey;          ///< Identifies the content of the animation, including the property overrides.
+        int frameNumber = 0;
+        int width = 0;                      ///< The width the frame is rasterised at, the render scale included.
+        int height = 0;                     ///< The height the frame is rasterised at, the render scale included.
+        bool antiAliasing = true;
+
+        bool operator== (const Key& other) const noexcept
+        {
+            return frameNumber == other.frameNumber
+                && width == other.width
+                && height == other.height
+                && antiAliasing == other.antiAliasing
+                && animationKey == other.animationKey;
+        }
+    };
+
+    //==============================================================================
+    /**
+     * @brief Enumerates the ways the cached frames can be stored.
+     */
+    enum class Compression
+    {
+        None,               ///< Frames are stored as images, retrieving a frame is free.
+        RunLength           ///< Frames are stored as per scanline runs of premultiplied pixels.
+    };
+
+    //==============================================================================
+    /**
+     * @brief Constructs a `LottieFrameCache` with a maximum size.
+     *
+     * @param maxSizeInBytes The maximum amount of memory the cached frames can use.
+     * @param compression The way the cached frames are stored.
+     */
+    explicit LottieFrameCache (std::size_t maxSizeInBytes, Compression compression = Compression::None);
+
+    /** @internal */
+    ~LottieFrameCache() override;
+
+    //==============================================================================
+    /**
+     * @brief Gets the cache shared by all the animations with `getInstance()`.
+     *
+     * Its initial maximum size is set by the `JOTTIE_FRAME_CACHE_SIZE` module option. The cache is deleted at shutdown,
+     * releasing its frames before the graphics back ends go away.
+     */
+    JUCE_DECLARE_SINGLETON (LottieFrameCache, false)
+
+    //==============================================================================
+    /**
+     * @brief Sets the maximum amount of memory the cached frames can use, evicting frames if needed.
+     *
+     * @param newMaxSizeInBytes The new maximum size in bytes.
+     */
+    void setMaximumSize (std::size_t newMaxSizeInBytes);
+
+    /**
+     * @brief Gets the maximum amount of memory the cached frames can use.
+     *
+     * @return The maximum size in bytes.
+     */
+    std::size_t getMaximumSize() const;
+
+    /**
+     * @brief Sets the way the cached frames are stored, removing all the frames if it changes.
+     *
+     * @param newCompression The new compression of the cached frames.
+     */
+    void setCompression (Compression newCompression);
+
+    /**
+     * @brief Gets the way the cached frames are stored.
+     *
+     * @return The compression of the cached frames.
+     */
+    Compression getCompression() const;
+
+    /**
+     * @brief Gets the amount of memory currently used by the cached frames.
+     *
+     * @return The current size in bytes.
+     */
+    std::size_t getCurrentSize() const;
+
+    /**
+     * @brief Gets the number of frames currently in the cache.
+     *
+     * @return The number of cached frames.
+     */
+    int getNumFrames() const;
+
+    //==============================================================================
+    /**
+     * @brief Looks up a frame in the cache, marking it as the most recently used.
+     *
+     * Uncompressed frames are shared with the cache by replacing the image, while compressed frames are decoded into
+     * the image, which is reallocated only if it has a different size or if it's shared with other images.
+     *
+     * @param key The key of the frame to look up.
+     * @param image The image receiving the cached frame, left untouched if the frame is not in the cache.
+     *
+     * @return True if the frame was found in the cache.
+     */
+    bool getFrame (const Key& key, juce::Image& image);
+
+    /**
+     * @brief Checks if a frame is in the cache, without affecting the eviction order.
+     *
+     * @param key The key of the frame to look up.
+     *
+     * @return True if the frame is in the cache.
+     */
+    bool containsFrame (const Key& key) const;
+
+    /**
+     * @brief Adds a rendered frame to the cache.
+     *
+     * When the frames are not compressed (or they don't compress well) the image is shared with the cache, so it
+     * must not be rendered into afterwards. Frames bigger than the maximum size of the cache are not stored.
+     *
+     * @param key The key of the frame to add.
+     * @param image The rendered frame.
+     */
+    void addFrame (const Key& key, const juce::Image& image);
+
+    /**
+     * @brief Removes all the frames of an animation from the cache.
+     *
+     * @param animationKey The key identifying the content of the animation.
+     */
+    void removeFrames (const juce::String& animationKey);
+
+    /**
+     * @brief Removes all the frames from the cache.
+     */
+    void clear();
+
+private:
+    struct KeyHash
+    {
+        std::size_t operator() (const Key& key) const noexcept;
+    };
+
+    struct Entry
+    {
+        Key key;
+        juce::Image image;
+        std::shared_ptr<const std::vector<juce::uint32>> encodedPixels;
+        std::size_t sizeInBytes = 0;
+    };
+
+    LottieFrameCache();
+
+    void evictFramesToFit (std::size_t sizeInBytes);
+
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> lookup;
+    std::size_t maxSize = 0;
+    std::size_t currentSize = 0;
+    Compression compression = Compression::None;
+    juce::CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LottieFrameCache)
+};
+
+} // namespace jottie
@@ -0,0 +1,197 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#include "jottie_LottieModelCache.h"
+
+namespace jottie {
+namespace {
+
+//==============================================================================
+LottieModelCache::ModelPtr parseModel (const juce::String& jsonData)
+{
+    if (jsonData.isEmpty())
+        return {};
+
+    if (auto model = lottie_model_from_data (jsonData.toRawUTF8(), "/"))
+        return LottieModelCache::ModelPtr (model, lottie_model_destroy);
+
+    return {};
+}
+
+LottieModelCache::ModelPtr loadModel (const juce::File& jsonFile)
+{
+    if (auto model = lottie_model_from_file (jsonFile.getFullPathName().toRawUTF8()))
+        return LottieModelCache::ModelPtr (model, lottie_model_destroy);
+
+    return {};
+}
+
+} // namespace
+
+//==============================================================================
+JUCE_IMPLEMENT_SINGLETON (LottieModelCache)
+
+LottieModelCache::~LottieModelCache()
+{
+    clearSingletonInstance();
+}
+
+//==============================================================================
+void LottieModelCache::setMaximumSize (std::size_t maxSizeInBytes)
+{
+    const juce::ScopedLock sl (lock);
+
+    maxSize = maxSizeInBytes;
+
+    evictModelsToFit (0);
+}
+
+std::size_t LottieModelCache::getMaximumSize() const
+{
+    const juce::ScopedLock sl (lock);
+
+    return maxSize;
+}
+
+std::size_t LottieModelCache::getCurrentSize() const
+{
+    const juce::ScopedLock sl (lock);
+
+    return currentSize;
+}
+
+int LottieModelCache::getNumModels() const
+{
+    const juce::ScopedLock sl (lock);
+
+    return static_cast<int> (entries.size());
+}
+
+//==============================================================================
+LottieModelCache::ModelPtr LottieModelCache::getOrParseModel (const juce::String& key, const std::function<juce::String()>& getData)
+{
+    return getOrCreateModel (key, [&getData] { return parseModel (getData()); });
+}
+
+LottieModelCache::ModelPtr LottieModelCache::getOrLoadModel (const juce::String& key, const juce::File& jsonFile)
+{
+    return getOrCreateModel (key, [&jsonFile] { return loadModel (jsonFile); });
+}
+
+LottieModelCache::ModelPtr LottieModelCache::getOrCreateModel (const juce::String& key, const std::function<ModelPtr()>& createModel)
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (auto it = lookup.find (key); it != lookup.end())
+        {
+            entries.splice (entries.begin(), entries, it->second);
+
+            return it->second->model;
+        }
+    }
+
+    auto model = createModel();
+    if (model == nullptr)
+        return {};
+
+    const auto sizeInBytes = lottie_model_get_memory_size (model.get());
+
+    const juce::ScopedLock sl (lock);
+
+    // another thread might have parsed the same model in the meantime
+    if (auto it = lookup.find (key); it != lookup.end())
+    {
+        entries.splice (entries.begin(), entries, it->second);
+
+        return it->second->model;
+    }
+
+    if (sizeInBytes > maxSize)
+        return model;
+
+    evictModelsToFit (sizeInBytes);
+
+    entries.push_front ({ key, model, sizeInBytes });
+    lookup[key] = entries.begin();
+
+    currentSize += sizeInBytes;
+
+    return model;
+}
+
+bool LottieModelCache::containsModel (const juce::String& key) const
+{
+    const juce::ScopedLock sl (lock);
+
+    return lookup.find (key) != lookup.end();
+}
+
+void LottieModelCache::removeModel (const juce::String& key)
+{
+    const juce::ScopedLock sl (lock);
+
+    auto it = lookup.find (key);
+    if (it == lookup.end())
+        return;
+
+    currentSize -= it->second->sizeInBytes;
+
+    entries.erase (it->second);
+    lookup.erase (it);
+}
+
+void LottieModelCache::clear()
+{
+    const juce::ScopedLock sl (lock);
+
+    lookup.clear();
+    entries.clear();
+
+    currentSize = 0;
+}
+
+//==============================================================================
+void LottieModelCache::evictModelsToFit (std::size_t sizeInBytes)
+{
+    while (! entries.empty() && currentSize + sizeInBytes > maxSize)
+    {
+        auto& entry = entries.back();
+
+        currentSize -= entry.sizeInBytes;
+
+        lookup.erase (entry.key);
+        entries.pop_back();
+    }
+}
+
+} // namespace jottie
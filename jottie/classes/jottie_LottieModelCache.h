@@ -0,0 +1,182 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include "../rlottie/inc/rlottie_capi.h"
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace jottie {
+
+//==============================================================================
+/**
+ * @brief A process wide, memory bounded cache of parsed Lottie animation models.
+ *
+ * Parsing a Lottie animation is by far the most expensive part of creating a `LottieAnimation`. The `LottieModelCache`
+ * keeps the parsed models by a stable key (the content of the animation data, or a file path and its modification
+ * time), so every `LottieAnimation` instantiated from the same source shares the same immutable model and only pays
+ * for its own renderer state.
+ *
+ * When adding a model would exceed the maximum size in bytes, the least recently used models are evicted from the
+ * cache. Evicted models stay alive as long as any animation created from them is alive.
+ *
+ * @see LottieAnimation
+ */
+class LottieModelCache : public juce::DeletedAtShutdown
+{
+public:
+    //==============================================================================
+    /**
+     * @brief A shared handle to a parsed Lottie model.
+     */
+    using ModelPtr = std::shared_ptr<Lottie_Model>;
+
+    //==============================================================================
+    /** @internal */
+    ~LottieModelCache() override;
+
+    //==============================================================================
+    /**
+     * @brief Gets the cache shared by all the animations with `getInstance()`.
+     *
+     * The cache is deleted at shutdown, models still used by animations stay alive until those are deleted.
+     */
+    JUCE_DECLARE_SINGLETON (LottieModelCache, false)
+
+    //==============================================================================
+    /**
+     * @brief Sets the maximum amount of memory used by the cached models, evicting models if needed.
+     *
+     * @param maxSizeInBytes The maximum size of the cache in bytes, 0 disables the cache.
+     */
+    void setMaximumSize (std::size_t maxSizeInBytes);
+
+    /**
+     * @brief Gets the maximum amount of memory used by the cached models.
+     *
+     * @return The maximum size of the cache in bytes.
+     */
+    std::size_t getMaximumSize() const;
+
+    /**
+     * @brief Gets the amount of memory currently used by the cached models.
+     *
+     * @return The current size of the cache in bytes.
+     */
+    std::size_t getCurrentSize() const;
+
+    /**
+     * @brief Gets the number of models currently in the cache.
+     *
+     * @return The number of cached models.
+     */
+    int getNumModels() const;
+
+    //==============================================================================
+    /**
+     * @brief Gets a model from the cache, parsing and adding it on a miss.
+     *
+     * The data is only requested when the model is not in the cache, so it's possible to skip reading a file when the
+     * model is already available. Parsing happens outside of the cache lock, so different models can be parsed
+     * concurrently.
+     *
+     * @param key A key uniquely identifying the animation data.
+     * @param getData A function returning the animation data, only called on a cache miss.
+     *
+     * @return The cached or parsed model, or nullptr if the data could not be parsed.
+     */
+    ModelPtr getOrParseModel (const juce::String& key, const std::function<juce::String()>& getData);
+
+    /**
+     * @brief Gets a model from the cache, loading it from a json file and adding it on a miss.
+     *
+     * The file is memory mapped copy-on-write and parsed in place, so large animations are never copied in memory.
+     *
+     * @param key A key uniquely identifying the file content.
+     * @param jsonFile The file containing the animation data, only read on a cache miss.
+     *
+     * @return The cached or loaded model, or nullptr if the file could not be parsed.
+     */
+    ModelPtr getOrLoadModel (const juce::String& key, const juce::File& jsonFile);
+
+    /**
+     * @brief Checks if a model is in the cache.
+     *
+     * @param key The key of the model.
+     *
+     * @return True if the model is cached, false otherwise.
+     */
+    bool containsModel (const juce::String& key) const;
+
+    /**
+     * @brief Removes a model from the cache.
+     *
+     * @param key The key of the model.
+     */
+    void removeModel (const juce::String& key);
+
+    /**
+     * @brief Removes all the models from the cache.
+     */
+    void clear();
+
+private:
+    struct Entry
+    {
+        juce::String key;
+        ModelPtr model;
+        std::size_t sizeInBytes = 0;
+    };
+
+    LottieModelCache() = default;
+
+    ModelPtr getOrCreateModel (const juce::String& key, const std::function<ModelPtr()>& createModel);
+
+    void evictModelsToFit (std::size_t sizeInBytes);
+
+    mutable juce::CriticalSection lock;
+    std::list<Entry> entries;
+    std::unordered_map<juce::String, std::list<Entry>::iterator> lookup;
+    std::size_t maxSize = 64 * 1024 * 1024;
+    std::size_t currentSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LottieModelCache)
+};
+
+} // namespace jottie
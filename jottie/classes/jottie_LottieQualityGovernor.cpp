@@ -0,0 +1,154 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#include "jottie_LottieQualityGovernor.h"
+
+namespace jottie {
+namespace {
+
+//==============================================================================
+// Weight of the last frame in the average render time.
+constexpr double averageWeight = 0.25;
+
+// Frames rendered at a quality before judging it, so the average reflects its cost.
+constexpr int minFramesToDegrade = 8;
+constexpr int minFramesToRecover = 60;
+
+// Fraction of the budget the average has to stay below before the quality is restored.
+constexpr double recoverThreshold = 0.5;
+
+} // namespace
+
+//==============================================================================
+LottieQualityGovernor::LottieQualityGovernor (double frameBudgetMilliseconds, int axesToDegrade)
+    : frameBudget (juce::jmax (0.0, frameBudgetMilliseconds))
+    , axes (axesToDegrade)
+{
+    updateLevels();
+}
+
+//==============================================================================
+void LottieQualityGovernor::setFrameBudget (double newFrameBudgetMilliseconds)
+{
+    frameBudget = juce::jmax (0.0, newFrameBudgetMilliseconds);
+}
+
+double LottieQualityGovernor::getFrameBudget() const
+{
+    return frameBudget;
+}
+
+void LottieQualityGovernor::setAxes (int newAxesToDegrade)
+{
+    if (axes == newAxesToDegrade)
+        return;
+
+    axes = newAxesToDegrade;
+
+    updateLevels();
+    reset();
+}
+
+int LottieQualityGovernor::getAxes() const
+{
+    return axes;
+}
+
+//==============================================================================
+bool LottieQualityGovernor::addFrameRenderTime (double milliseconds)
+{
+    averageRenderTime = numFramesAtLevel == 0
+        ? milliseconds
+        : averageRenderTime + (milliseconds - averageRenderTime) * averageWeight;
+
+    ++numFramesAtLevel;
+
+    // when skipping frames, each rendered frame has the time of the skipped ones as well
+    const auto budget = frameBudget * static_cast<double> (levels[currentLevel].frameRateDivisor);
+
+    if (averageRenderTime > budget && numFramesAtLevel >= minFramesToDegrade && currentLevel + 1 < levels.size())
+    {
+        ++currentLevel;
+        numFramesAtLevel = 0;
+        return true;
+    }
+
+    if (averageRenderTime < budget * recoverThreshold && numFramesAtLevel >= minFramesToRecover && currentLevel > 0)
+    {
+        --currentLevel;
+        numFramesAtLevel = 0;
+        return true;
+    }
+
+    return false;
+}
+
+LottieQualityGovernor::Quality LottieQualityGovernor::getQuality() const
+{
+    return levels[currentLevel];
+}
+
+void LottieQualityGovernor::reset()
+{
+    currentLevel = 0;
+    averageRenderTime = 0.0;
+    numFramesAtLevel = 0;
+}
+
+//==============================================================================
+void LottieQualityGovernor::updateLevels()
+{
+    // each level degrades the previous one a step further, from the least to the most noticeable
+    Quality quality;
+
+    levels.clear();
+    levels.push_back (quality);
+
+    const auto addLevel = [&] (int axis, auto&& degrade)
+    {
+        if ((axes & axis) == 0)
+            return;
+
+        degrade (quality);
+        levels.push_back (quality);
+    };
+
+    addLevel (AntiAliasing, [] (Quality& q) { q.antiAliasing = false; });
+    addLevel (RenderScale, [] (Quality& q) { q.renderScale = 0.75f; });
+    addLevel (FrameRate, [] (Quality& q) { q.frameRateDivisor = 2; });
+    addLevel (RenderScale, [] (Quality& q) { q.renderScale = 0.5f; });
+    addLevel (FrameRate, [] (Quality& q) { q.frameRateDivisor = 3; });
+
+    currentLevel = juce::jmin (currentLevel, levels.size() - 1);
+}
+
+} // namespace jottie
@@ -0,0 +1,163 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <vector>
+
+namespace jottie {
+
+//==============================================================================
+/**
+ * @brief Adapts the quality of the rendered frames of an animation to a render time budget.
+ *
+ * The `LottieQualityGovernor` class is fed the time taken to rasterise each frame. When the average is over the
+ * budget, the quality is degraded one step along the enabled axes: disabling anti-aliasing, rasterising at a lower
+ * resolution that is upscaled when rendered, and rendering fewer frames per second. When the average falls well
+ * below the budget for a while, the quality is restored one step at a time.
+ *
+ * @see LottieAnimation::setRenderBudget
+ */
+class LottieQualityGovernor
+{
+public:
+    //==============================================================================
+    /**
+     * @brief Enumerates the axes the quality can be degraded along, to be combined as flags.
+     */
+    enum Axis
+    {
+        AntiAliasing        = 1 << 0,   ///< Edges are rasterised without anti-aliasing.
+        RenderScale         = 1 << 1,   ///< Frames are rasterised at a lower resolution and upscaled.
+        FrameRate           = 1 << 2,   ///< Only one every few frames is rendered.
+        AllAxes             = AntiAliasing | RenderScale | FrameRate
+    };
+
+    //==============================================================================
+    /**
+     * @brief The quality frames are rendered at.
+     */
+    struct Quality
+    {
+        bool antiAliasing = true;
+        float renderScale = 1.0f;
+        int frameRateDivisor = 1;
+
+        bool operator== (const Quality& other) const noexcept
+        {
+            return antiAliasing == other.antiAliasing
+                && juce::exactlyEqual (renderScale, other.renderScale)
+                && frameRateDivisor == other.frameRateDivisor;
+        }
+
+        bool operator!= (const Quality& other) const noexcept
+        {
+            return ! operator== (other);
+        }
+    };
+
+    //==============================================================================
+    /**
+     * @brief Constructs a `LottieQualityGovernor` with a render time budget.
+     *
+     * @param frameBudgetMilliseconds The time a frame should take to be rasterised at most, in milliseconds.
+     * @param axesToDegrade The combination of `Axis` flags the quality can be degraded along.
+     */
+    explicit LottieQualityGovernor (double frameBudgetMilliseconds, int axesToDegrade = AllAxes);
+
+    //==============================================================================
+    /**
+     * @brief Sets the time a frame should take to be rasterised at most.
+     *
+     * @param newFrameBudgetMilliseconds The new budget in milliseconds.
+     */
+    void setFrameBudget (double newFrameBudgetMilliseconds);
+
+    /**
+     * @brief Gets the time a frame should take to be rasterised at most.
+     *
+     * @return The budget in milliseconds.
+     */
+    double getFrameBudget() const;
+
+    /**
+     * @brief Sets the axes the quality can be degraded along, restoring the full quality.
+     *
+     * @param newAxesToDegrade The combination of `Axis` flags the quality can be degraded along.
+     */
+    void setAxes (int newAxesToDegrade);
+
+    /**
+     * @brief Gets the axes the quality can be degraded along.
+     *
+     * @return The combination of `Axis` flags.
+     */
+    int getAxes() const;
+
+    //==============================================================================
+    /**
+     * @brief Records the time taken to rasterise a frame at the current quality.
+     *
+     * @param milliseconds The time taken to rasterise the frame, in milliseconds.
+     *
+     * @return True if the quality changed.
+     */
+    bool addFrameRenderTime (double milliseconds);
+
+    /**
+     * @brief Gets the quality frames should be rendered at.
+     *
+     * @return The current quality.
+     */
+    Quality getQuality() const;
+
+    /**
+     * @brief Restores the full quality and forgets the recorded render times.
+     */
+    void reset();
+
+private:
+    void updateLevels();
+
+    double frameBudget = 0.0;
+    int axes = AllAxes;
+    std::vector<Quality> levels;
+    std::size_t currentLevel = 0;
+    double averageRenderTime = 0.0;
+    int numFramesAtLevel = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LottieQualityGovernor)
+};
+
+} // namespace jottie
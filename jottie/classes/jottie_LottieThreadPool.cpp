@@ -0,0 +1,86 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#include "jottie_LottieThreadPool.h"
+
+namespace jottie {
+namespace {
+
+//==============================================================================
+void addRenderJob (Lottie_Task_Job job, void* jobData, void* userData)
+{
+    static_cast<juce::ThreadPool*> (userData)->addJob ([job, jobData] { job (jobData); });
+}
+
+//==============================================================================
+class SharedThreadPool : public juce::ThreadPool, public juce::DeletedAtShutdown
+{
+public:
+    SharedThreadPool()
+        : juce::ThreadPool (juce::ThreadPoolOptions()
+                                .withThreadName ("jottie loader")
+                                .withNumberOfThreads (juce::jmax (1, juce::SystemStats::getNumCpus() - 1)))
+    {
+    }
+
+    ~SharedThreadPool() override
+    {
+        clearSingletonInstance();
+    }
+
+    JUCE_DECLARE_SINGLETON (SharedThreadPool, false)
+};
+
+JUCE_IMPLEMENT_SINGLETON (SharedThreadPool)
+
+} // namespace
+
+//==============================================================================
+juce::ThreadPool& LottieThreadPool::getInstance()
+{
+    return *SharedThreadPool::getInstance();
+}
+
+//==============================================================================
+void LottieThreadPool::setNumRenderThreads (int numThreads)
+{
+    lottie_configure_thread_pool (static_cast<std::size_t> (juce::jmax (0, numThreads)));
+}
+
+void LottieThreadPool::useForRendering (juce::ThreadPool& threadPool, int maxConcurrentJobs)
+{
+    lottie_configure_task_executor (addRenderJob,
+                                    std::addressof (threadPool),
+                                    static_cast<std::size_t> (juce::jmax (0, maxConcurrentJobs)));
+}
+
+} // namespace jottie
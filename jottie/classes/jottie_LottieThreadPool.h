@@ -0,0 +1,88 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+namespace jottie {
+
+//==============================================================================
+/**
+ * @brief The thread pool used to load and parse Lottie animations in background.
+ *
+ * The pool is created on first use, with one thread less than the number of available CPUs so the message thread is
+ * never starved while many animations are being loaded. It is deleted at shutdown, waiting for the running jobs.
+ *
+ * Rendering uses a separate pool owned by rLottie, shared by every animation, which can be resized or moved onto a
+ * juce::ThreadPool of the application. It is only used when JOTTIE_ENABLE_THREAD_SUPPORT is enabled.
+ *
+ * @see LottieComponent, LottieFile
+ */
+class LottieThreadPool
+{
+public:
+    //==============================================================================
+    /**
+     * @brief Gets the thread pool shared by all the jottie classes.
+     *
+     * @return The shared thread pool.
+     */
+    static juce::ThreadPool& getInstance();
+
+    //==============================================================================
+    /**
+     * @brief Sets the number of threads rLottie renders with, stopping them from running on a juce::ThreadPool.
+     *
+     * Must not be called while animations are rendering, the render threads are restarted on the next frame.
+     *
+     * @param numThreads The number of render threads, 0 for one per CPU.
+     */
+    static void setNumRenderThreads (int numThreads);
+
+    /**
+     * @brief Makes rLottie render on a juce::ThreadPool instead of its own threads.
+     *
+     * The jobs added to the pool never block, but jobs already in the pool must not wait for a render to complete or
+     * they could wait for themselves. Must not be called while animations are rendering.
+     *
+     * @param threadPool The pool to render on, it must outlive any rendering or the next call to this class.
+     * @param maxConcurrentJobs The maximum number of render jobs queued to the pool at once, 0 for one per CPU.
+     */
+    static void useForRendering (juce::ThreadPool& threadPool, int maxConcurrentJobs);
+
+private:
+    LottieThreadPool() = delete;
+};
+
+} // namespace jottie
@@ -78,6 +78,9 @@
 #pragma clang diagnostic ignored "-Wswitch-enum"
 #pragma clang diagnostic ignored "-Wextra-semi"
 #pragma clang diagnostic ignored "-Wcomma"
+#elif defined (__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized" // GCC 12 trips over _mm512_undefined_epi32 in its own headers
 #endif
 
 #include "rlottie/src/lottie/zip/zip.cpp"
@@ -97,6 +100,8 @@
 #include "rlottie/src/vector/vdrawhelper_common.cpp"
 #include "rlottie/src/vector/vdrawhelper.cpp"
 #include "rlottie/src/vector/vdrawhelper_sse2.cpp"
+#include "rlottie/src/vector/vdrawhelper_avx2.cpp"
+#include "rlottie/src/vector/vdrawhelper_avx512.cpp"
 #include "rlottie/src/vector/vdrawhelper_neon.cpp"
 #include "rlottie/src/vector/vrle.cpp"
 #include "rlottie/src/vector/vpath.cpp"
@@ -120,10 +125,18 @@
 #pragma warning (pop)
 #elif defined (__clang__)
 #pragma clang diagnostic pop
+#elif defined (__GNUC__)
+#pragma GCC diagnostic pop
 #endif
 
 #include "classes/jottie_LottieComponent.cpp"
 #include "classes/jottie_LottieAnimation.cpp"
+#include "classes/jottie_LottieAnimationClock.cpp"
 #include "classes/jottie_LottieFile.cpp"
+#include "classes/jottie_LottieContentHash.cpp"
+#include "classes/jottie_LottieFrameCache.cpp"
+#include "classes/jottie_LottieModelCache.cpp"
+#include "classes/jottie_LottieQualityGovernor.cpp"
+#include "classes/jottie_LottieThreadPool.cpp"
 
 #endif
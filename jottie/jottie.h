@@ -61,6 +61,14 @@
  #define JOTTIE_ENABLE_THREAD_SUPPORT 0
 #endif
 
+//==============================================================================
+/** Config: JOTTIE_THREAD_POOL_SIZE
+    Number of worker threads used by the low level rLottie library when thread support is on, 0 uses one per CPU.
+*/
+#if !defined (JOTTIE_THREAD_POOL_SIZE)
+ #define JOTTIE_THREAD_POOL_SIZE 0
+#endif
+
 //==============================================================================
 /** Config: JOTTIE_ENABLE_MODEL_CACHE
     If this option is turned on, the low level rLottie library will cache loaded animation models.
@@ -69,6 +77,22 @@
  #define JOTTIE_ENABLE_MODEL_CACHE 1
 #endif
 
+//==============================================================================
+/** Config: JOTTIE_FRAME_CACHE_SIZE
+    Initial maximum amount of memory in bytes used by the rendered frames cached for all the animations.
+*/
+#if !defined (JOTTIE_FRAME_CACHE_SIZE)
+ #define JOTTIE_FRAME_CACHE_SIZE (64 * 1024 * 1024)
+#endif
+
+//==============================================================================
+/** Config: JOTTIE_ENABLE_SIMD_DISPATCH
+    If this option is turned on, the low level rLottie library will pick AVX2 or AVX-512 rendering kernels at runtime on CPUs that support them.
+*/
+#if !defined (JOTTIE_ENABLE_SIMD_DISPATCH)
+ #define JOTTIE_ENABLE_SIMD_DISPATCH 1
+#endif
+
 //==============================================================================
 /** Config: JOTTIE_ENABLE_LOGGING
     If this option is turned on, the low level rLottie library will produce logging output, useful for debugging.
@@ -94,6 +118,12 @@
 
 #include "classes/jottie_LottieComponent.h"
 #include "classes/jottie_LottieAnimation.h"
+#include "classes/jottie_LottieAnimationClock.h"
 #include "classes/jottie_LottieFile.h"
+#include "classes/jottie_LottieContentHash.h"
+#include "classes/jottie_LottieFrameCache.h"
+#include "classes/jottie_LottieModelCache.h"
+#include "classes/jottie_LottieQualityGovernor.h"
+#include "classes/jottie_LottieThreadPool.h"
 
 #endif
@@ -36,12 +36,17 @@
 // rLottie options
 #if JOTTIE_ENABLE_THREAD_SUPPORT
   #define LOTTIE_THREAD_SUPPORT 1
+  #define LOTTIE_THREAD_POOL_SIZE JOTTIE_THREAD_POOL_SIZE
 #endif
 
 #if JOTTIE_ENABLE_MODEL_CACHE
   #define LOTTIE_CACHE_SUPPORT 1
 #endif
 
+#if JOTTIE_ENABLE_SIMD_DISPATCH
+  #define LOTTIE_SIMD_DISPATCH_SUPPORT 1
+#endif
+
 #if JOTTIE_ENABLE_LOGGING_SUPPORT
   #define LOTTIE_LOGGING_SUPPORT 1
 #endif
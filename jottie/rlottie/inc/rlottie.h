@@ -23,6 +23,7 @@
 #ifndef _RLOTTIE_H_
 #define _RLOTTIE_H_
 
+#include <functional>
 #include <future>
 #include <vector>
 #include <memory>
@@ -51,6 +52,35 @@ struct LOTLayerNode;
 
 namespace rlottie {
 
+namespace internal {
+namespace model {
+class Composition;
+}
+}
+
+/**
+ *  @brief Shared handle to an immutable parsed Lottie resource.
+ *
+ *  A model can be used to construct any number of animation objects
+ *  without parsing the resource again.
+ *
+ *  @internal
+ */
+using Model = std::shared_ptr<internal::model::Composition>;
+
+/**
+ *  @brief Returns the approximate memory used by a parsed model.
+ *
+ *  Accounts for the model arena and the decoded image assets.
+ *
+ *  @param[in] model The model.
+ *
+ *  @return approximate memory used by the model in bytes.
+ *
+ *  @internal
+ */
+RLOTTIE_API size_t modelMemorySize(const Model &model);
+
 /**
  *  @brief Configures rlottie model cache policy.
  *
@@ -68,6 +98,83 @@ namespace rlottie {
  */
 RLOTTIE_API void configureModelCacheSize(size_t cacheSize);
 
+/**
+ *  @brief Configures the maximum memory used by the rlottie model cache.
+ *
+ *  When the approximate memory used by the cached models exceeds the
+ *  given size, the least recently used models are evicted. By default
+ *  the memory is unbounded and only the number of models is limited.
+ *
+ *  @param[in] memorySize  Maximum Model Cache memory in bytes.
+ *
+ *  @see configureModelCacheSize()
+ *
+ *  @internal
+ */
+RLOTTIE_API void configureModelCacheMemorySize(size_t memorySize);
+
+/**
+ *  @brief Statistics of the rlottie model cache.
+ *
+ *  @internal
+ */
+struct ModelCacheStats {
+    size_t hits{0};        /*!< Number of lookups that found a cached model */
+    size_t misses{0};      /*!< Number of lookups that had to parse the model */
+    size_t evictions{0};   /*!< Number of models evicted to respect the limits */
+    size_t entries{0};     /*!< Number of models currently in the cache */
+    size_t memorySize{0};  /*!< Approximate memory used by the cached models */
+};
+
+/**
+ *  @brief Returns the statistics of the rlottie model cache.
+ *
+ *  @return current statistics of the model cache.
+ *
+ *  @internal
+ */
+RLOTTIE_API ModelCacheStats modelCacheStats();
+
+/**
+ *  @brief Configures the number of worker threads of the rlottie pool.
+ *
+ *  Rasterization, asynchronous rendering and the bands of large frames
+ *  all share a single pool of worker threads. By default it starts one
+ *  worker per hardware thread the first time it is needed.
+ *
+ *  @param[in] threadCount  Number of worker threads, 0 for one per
+ *                          hardware thread.
+ *
+ *  @note Has no effect unless rlottie is built with thread support.
+ *  @note A running pool is stopped and restarted with the new size on its
+ *        next use, so this must not be called while rendering.
+ *
+ *  @internal
+ */
+RLOTTIE_API void configureThreadPool(size_t threadCount);
+
+using TaskExecutor = std::function<void(std::function<void()> job)>;
+
+/**
+ *  @brief Runs the rlottie pool on a host provided executor.
+ *
+ *  Instead of starting its own threads, rlottie submits jobs to the
+ *  executor which run the pending tasks until none are left. At most
+ *  maxConcurrency jobs are submitted at the same time.
+ *
+ *  @param[in] executor        Executor running the jobs, or an empty
+ *                             function to go back to rlottie threads.
+ *  @param[in] maxConcurrency  Maximum number of jobs submitted at once,
+ *                             0 for one per hardware thread.
+ *
+ *  @note The executor threads must not block on rlottie render results.
+ *  @note Same restrictions as configureThreadPool() apply.
+ *
+ *  @internal
+ */
+RLOTTIE_API void configureTaskExecutor(TaskExecutor executor,
+                                       size_t       maxConcurrency);
+
 struct Color {
     Color() = default;
     Color(float r, float g , float b):_r(r), _g(g), _b(b){}
@@ -160,6 +267,42 @@ public:
      */
     void setDrawRegion(size_t x, size_t y, size_t width, size_t height);
 
+    /**
+     *  @brief Sets the Clip Area of the Surface.
+     *
+     *  Lottie will only update the pixels of the surface inside the clip
+     *  region, and leave the rest of the surface untouched. Unlike the draw
+     *  region it doesn't affect the size of the generated frame image.
+     *
+     *  @param[in] x      region area x position.
+     *  @param[in] y      region area y position.
+     *  @param[in] width  region area width.
+     *  @param[in] height region area height.
+     *
+     *  @note Default clip region area is [ 0 , 0, surface width , surface height]
+     *
+     *  @internal
+     */
+    void setClipRegion(size_t x, size_t y, size_t width, size_t height);
+
+    /**
+     *  @brief Marks the surface as holding the last frame rendered into it.
+     *
+     *  Lottie will then only redraw the area that changed since that frame
+     *  and leave the rest of the surface untouched.
+     *
+     *  @param[in] incremental whether the surface content can be reused.
+     *
+     *  @note Default value is false, the whole draw region is redrawn.
+     *  @note The content is reused only if the buffer, its size and the draw
+     *        region are the same as in the last render of the animation.
+     *
+     *  @see Animation::damagedRegion()
+     *
+     *  @internal
+     */
+    void setIncremental(bool incremental) {mIncremental = incremental;}
+
     /**
      *  @brief Returns width of the surface.
      *
@@ -242,6 +385,61 @@ public:
      */
     size_t drawRegionPosY() const {return mDrawArea.y;}
 
+    /**
+     *  @brief Returns whether the surface content can be reused.
+     *
+     *  @return true if only the changed area has to be redrawn.
+     *
+     *  @note Default value is false
+     *
+     *  @internal
+     */
+    bool incremental() const {return mIncremental;}
+
+    /**
+     *  @brief Returns clip area width of the surface.
+     *
+     *  @return clip area width
+     *
+     *  @note Default value is width() of the surface
+     *
+     *  @internal
+     */
+    size_t clipRegionWidth() const {return mClipArea.w;}
+
+    /**
+     *  @brief Returns clip area height of the surface.
+     *
+     *  @return clip area height
+     *
+     *  @note Default value is height() of the surface
+     *
+     *  @internal
+     */
+    size_t clipRegionHeight() const {return mClipArea.h;}
+
+    /**
+     *  @brief Returns clip area's x position of the surface.
+     *
+     *  @return clip area's x position.
+     *
+     *  @note Default value is 0
+     *
+     *  @internal
+     */
+    size_t clipRegionPosX() const {return mClipArea.x;}
+
+    /**
+     *  @brief Returns clip area's y position of the surface.
+     *
+     *  @return clip area's y position.
+     *
+     *  @note Default value is 0
+     *
+     *  @internal
+     */
+    size_t clipRegionPosY() const {return mClipArea.y;}
+
     /**
      *  @brief Default constructor.
      */
@@ -251,12 +449,19 @@ private:
     size_t       mWidth{0};
     size_t       mHeight{0};
     size_t       mBytesPerLine{0};
+    bool         mIncremental{false};
     struct {
         size_t   x{0};
         size_t   y{0};
         size_t   w{0};
         size_t   h{0};
     }mDrawArea;
+    struct {
+        size_t   x{0};
+        size_t   y{0};
+        size_t   w{0};
+        size_t   h{0};
+    }mClipArea;
 };
 
 using MarkerList = std::vector<std::tuple<std::string, int , int>>;
@@ -329,6 +534,49 @@ public:
     static std::unique_ptr<Animation>
     loadFromData(std::string jsonData, std::string resourcePath, ColorFilter filter);
 
+    /**
+     *  @brief Constructs an animation object from an already parsed model.
+     *
+     *  @param[in] model The model shared by the animation object.
+     *
+     *  @return Animation object that can render the contents of the
+     *          Lottie resource represented by the model.
+     *
+     *  @see loadModelFromData()
+     *
+     *  @internal
+     */
+    static std::unique_ptr<Animation>
+    loadFromModel(Model model);
+
+    /**
+     *  @brief Parses JSON string data into a model, bypassing the model cache.
+     *
+     *  @param[in] jsonData The JSON string data.
+     *  @param[in] resourcePath the path will be used to search for external resource.
+     *
+     *  @return The parsed model, or an empty model if parsing failed.
+     *
+     *  @internal
+     */
+    static Model
+    loadModelFromData(std::string jsonData, const std::string &resourcePath="");
+
+    /**
+     *  @brief Parses a Lottie resource file into a model, bypassing the model cache.
+     *
+     *  Where supported the file is memory mapped copy-on-write and parsed in place,
+     *  without reading it into an intermediate buffer.
+     *
+     *  @param[in] path Lottie resource file path.
+     *
+     *  @return The parsed model, or an empty model if parsing failed.
+     *
+     *  @internal
+     */
+    static Model
+    loadModelFromFile(const std::string &path);
+
     /**
      *  @brief Returns default framerate of the Lottie resource.
      *
@@ -425,6 +673,54 @@ public:
      */
     void              renderSync(size_t frameNo, Surface surface, bool keepAspectRatio=true);
 
+    /**
+     *  @brief Returns the area of the surface redrawn by the last render.
+     *
+     *  The part of the draw region inside the clip region for a regular
+     *  surface, only the area of it that changed since the previous frame
+     *  for an incremental one.
+     *
+     *  @param[out] x      damaged area x position.
+     *  @param[out] y      damaged area y position.
+     *  @param[out] width  damaged area width, 0 if nothing was redrawn.
+     *  @param[out] height damaged area height, 0 if nothing was redrawn.
+     *
+     *  @see Surface::setIncremental()
+     *  @internal
+     */
+    void damagedRegion(size_t &x, size_t &y, size_t &width, size_t &height) const;
+
+    /**
+     *  @brief Sets whether the edges of the content are anti-aliased.
+     *
+     *  Without anti-aliasing the pixels are either covered or not, which
+     *  is cheaper to rasterize and blend at the cost of jagged edges.
+     *
+     *  @param[in] antialiasing whether to anti-alias the content.
+     *
+     *  @note Default value is true.
+     *  @note Must not be called while a render of the animation is in progress.
+     *
+     *  @internal
+     */
+    void setAntialiasing(bool antialiasing);
+
+    /**
+     *  @brief Sets a function called by the worker thread when an async
+     *         render started with render() is finished.
+     *
+     *  The function is called before the future returned by render() is
+     *  made ready, so the animation is still alive while it runs.
+     *
+     *  @param[in] callback function to call, or an empty function to stop
+     *                      receiving the notifications.
+     *
+     *  @note Must not be called while a render of the animation is in progress.
+     *
+     *  @internal
+     */
+    void setRenderCallback(std::function<void()> callback);
+
     /**
      *  @brief Returns root layer of the composition updated with
      *         content of the Lottie resource at frame number @p frameNo.
@@ -45,6 +45,15 @@ typedef enum {
 }Lottie_Animation_Property;
 
 typedef struct Lottie_Animation_S Lottie_Animation;
+typedef struct Lottie_Model_S Lottie_Model;
+
+typedef struct {
+    size_t hits;         /*!< Number of lookups that found a cached model */
+    size_t misses;       /*!< Number of lookups that had to parse the model */
+    size_t evictions;    /*!< Number of models evicted to respect the limits */
+    size_t entries;      /*!< Number of models currently in the cache */
+    size_t memory_size;  /*!< Approximate memory used by the cached models in bytes */
+} Lottie_Model_Cache_Stats;
 
 /**
  *  @brief Runs lottie initialization code when rlottie library is loaded
@@ -106,6 +115,85 @@ RLOTTIE_API Lottie_Animation *lottie_animation_from_file(const char *path);
  */
 RLOTTIE_API Lottie_Animation *lottie_animation_from_data(const char *data, const char *key, const char *resource_path);
 
+/**
+ *  @brief Parses JSON string data into a model that can be shared by many animation objects.
+ *
+ *  The model is not stored in the library model cache, its lifetime is controlled by the caller.
+ *
+ *  @param[in] data The JSON string data.
+ *  @param[in] resource_path the path that will be used to load external resource needed by the JSON data.
+ *
+ *  @return Model object, or @c NULL if the data can't be parsed.
+ *
+ *  @see lottie_model_destroy()
+ *  @see lottie_animation_from_model()
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API Lottie_Model *lottie_model_from_data(const char *data, const char *resource_path);
+
+/**
+ *  @brief Parses a Lottie resource file into a model that can be shared by many animation objects.
+ *
+ *  Where supported the file is memory mapped copy-on-write and parsed in place, avoiding any
+ *  intermediate copy of its content. The model is not stored in the library model cache.
+ *
+ *  @param[in] path Lottie resource file path.
+ *
+ *  @return Model object, or @c NULL if the file can't be read or parsed.
+ *
+ *  @see lottie_model_destroy()
+ *  @see lottie_animation_from_model()
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API Lottie_Model *lottie_model_from_file(const char *path);
+
+/**
+ *  @brief Free given Model object resource.
+ *
+ *  Animation objects constructed from the model keep it alive, so the model can be
+ *  destroyed while they are still in use.
+ *
+ *  @param[in] model Model object to free.
+ *
+ *  @see lottie_model_from_data()
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API void lottie_model_destroy(Lottie_Model *model);
+
+/**
+ *  @brief Returns the approximate memory used by the given Model object.
+ *
+ *  @param[in] model Model object.
+ *
+ *  @return The approximate memory used by the model in bytes.
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API size_t lottie_model_get_memory_size(const Lottie_Model *model);
+
+/**
+ *  @brief Constructs an animation object sharing an already parsed model.
+ *
+ *  @param[in] model The Model object.
+ *
+ *  @return Animation object that can build the contents of the
+ *          Lottie resource represented by the model.
+ *
+ *  @see lottie_model_from_data()
+ *  @see lottie_animation_destroy()
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API Lottie_Animation *lottie_animation_from_model(const Lottie_Model *model);
+
 /**
  *  @brief Free given Animation object resource.
  *
@@ -231,6 +319,97 @@ RLOTTIE_API size_t lottie_animation_get_frame_at_pos(const Lottie_Animation *ani
  */
 RLOTTIE_API void lottie_animation_render(Lottie_Animation *animation, size_t frame_num, uint32_t *buffer, size_t width, size_t height, size_t bytes_per_line);
 
+/**
+ *  @brief Request to render the content of the frame @p frame_num to buffer @p buffer,
+ *         redrawing only the area that changed since the last rendered frame.
+ *
+ *  @param[in] animation Animation object.
+ *  @param[in] frame_num the frame number needs to be rendered.
+ *  @param[in] buffer surface buffer use for rendering, holding the last frame rendered by @p animation.
+ *  @param[in] width width of the surface
+ *  @param[in] height height of the surface
+ *  @param[in] bytes_per_line stride of the surface in bytes.
+ *
+ *  @note the whole surface is redrawn if the buffer or its size changed since the last render.
+ *
+ *  @see lottie_animation_get_damaged_region()
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API void lottie_animation_render_incremental(Lottie_Animation *animation, size_t frame_num, uint32_t *buffer, size_t width, size_t height, size_t bytes_per_line);
+
+/**
+ *  @brief Request to render the content of the frame @p frame_num to buffer @p buffer,
+ *         updating only the pixels inside the clip region.
+ *
+ *  The rest of the buffer is left untouched, so only the visible portion of the animation needs to be rendered.
+ *
+ *  @param[in] animation Animation object.
+ *  @param[in] frame_num the frame number needs to be rendered.
+ *  @param[in] buffer surface buffer use for rendering.
+ *  @param[in] width width of the surface
+ *  @param[in] height height of the surface
+ *  @param[in] bytes_per_line stride of the surface in bytes.
+ *  @param[in] clip_x x position of the clip region.
+ *  @param[in] clip_y y position of the clip region.
+ *  @param[in] clip_width width of the clip region.
+ *  @param[in] clip_height height of the clip region.
+ *  @param[in] incremental non zero if @p buffer holds the last frame rendered by @p animation,
+ *                         @see lottie_animation_render_incremental()
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API void lottie_animation_render_clipped(Lottie_Animation *animation, size_t frame_num, uint32_t *buffer, size_t width, size_t height, size_t bytes_per_line, size_t clip_x, size_t clip_y, size_t clip_width, size_t clip_height, int incremental);
+
+/**
+ *  @brief Returns the area of the buffer redrawn by the last render.
+ *
+ *  @param[in] animation Animation object.
+ *  @param[out] x damaged area x position.
+ *  @param[out] y damaged area y position.
+ *  @param[out] width damaged area width, @c 0 if nothing was redrawn.
+ *  @param[out] height damaged area height, @c 0 if nothing was redrawn.
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API void lottie_animation_get_damaged_region(const Lottie_Animation *animation, size_t *x, size_t *y, size_t *width, size_t *height);
+
+/**
+ *  @brief Sets whether the edges of the content are anti-aliased.
+ *
+ *  Without anti-aliasing the pixels are either covered or not, which is cheaper to rasterize and blend
+ *  at the cost of jagged edges.
+ *
+ *  @param[in] animation Animation object.
+ *  @param[in] antialiasing non zero to anti-alias the content, the default.
+ *
+ *  @note Must not be called while an async render job of @p animation is in progress.
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API void lottie_animation_set_antialiasing(Lottie_Animation *animation, int antialiasing);
+
+/**
+ *  @brief Sets a function called when an async render job of this animation object is finished.
+ *
+ *  The function is called by the worker thread that rendered the frame, right before the job is marked as
+ *  finished, so lottie_animation_render_flush() is not going to block for long once it has been called.
+ *
+ *  @param[in] animation Animation object.
+ *  @param[in] callback function to call, or @c NULL to stop receiving the notifications.
+ *  @param[in] user_data pointer passed to @p callback.
+ *
+ *  @note Must not be called while an async render job of @p animation is in progress.
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API void lottie_animation_set_render_callback(Lottie_Animation *animation, void (*callback)(void *user_data), void *user_data);
+
 /**
  *  @brief Request to render the content of the frame @p frame_num to buffer @p buffer asynchronously.
  *
@@ -248,6 +427,32 @@ RLOTTIE_API void lottie_animation_render(Lottie_Animation *animation, size_t fra
  */
 RLOTTIE_API void lottie_animation_render_async(Lottie_Animation *animation, size_t frame_num, uint32_t *buffer, size_t width, size_t height, size_t bytes_per_line);
 
+/**
+ *  @brief Request to render the content of the frame @p frame_num to buffer @p buffer asynchronously,
+ *         updating only the pixels inside the clip region.
+ *
+ *  @param[in] animation Animation object.
+ *  @param[in] frame_num the frame number needs to be rendered.
+ *  @param[in] buffer surface buffer use for rendering.
+ *  @param[in] width width of the surface
+ *  @param[in] height height of the surface
+ *  @param[in] bytes_per_line stride of the surface in bytes.
+ *  @param[in] clip_x x position of the clip region.
+ *  @param[in] clip_y y position of the clip region.
+ *  @param[in] clip_width width of the clip region.
+ *  @param[in] clip_height height of the clip region.
+ *  @param[in] incremental non zero if @p buffer holds the last frame rendered by @p animation,
+ *                         @see lottie_animation_render_incremental()
+ *
+ *  @note user must call lottie_animation_render_flush() to make sure render is finished.
+ *
+ *  @see lottie_animation_render_clipped()
+ *
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API void lottie_animation_render_clipped_async(Lottie_Animation *animation, size_t frame_num, uint32_t *buffer, size_t width, size_t height, size_t bytes_per_line, size_t clip_x, size_t clip_y, size_t clip_width, size_t clip_height, int incremental);
+
 /**
  *  @brief Request to finish the current async renderer job for this animation object.
  *  If render is finished then this call returns immidiately.
@@ -265,6 +470,21 @@ RLOTTIE_API void lottie_animation_render_async(Lottie_Animation *animation, size
  */
 RLOTTIE_API uint32_t *lottie_animation_render_flush(Lottie_Animation *animation);
 
+/**
+ *  @brief Checks whether the current async renderer job for this animation object is finished.
+ *  This call never blocks, so it can be used to poll for the completion of a
+ *  job started with lottie_animation_render_async() before calling
+ *  lottie_animation_render_flush().
+ *  @param[in] animation Animation object.
+ *  @return non zero if there is no pending render job or if it is finished,
+ *          @c 0 if the render job is still in progress.
+ *  @see lottie_animation_render_async()
+ *  @see lottie_animation_render_flush()
+ *  @ingroup Lottie_Animation
+ *  @internal
+ */
+RLOTTIE_API int lottie_animation_render_ready(Lottie_Animation *animation);
+
 
 /**
  *  @brief Request to change the properties of this animation object.
@@ -321,6 +541,69 @@ RLOTTIE_API const LOTMarkerList* lottie_animation_get_markerlist(Lottie_Animatio
  */
 RLOTTIE_API void lottie_configure_model_cache_size(size_t cacheSize);
 
+/**
+ *  @brief Configures the maximum memory used by the rlottie model cache.
+ *
+ *  When the approximate memory used by the cached models exceeds the
+ *  given size, the least recently used models are evicted.
+ *
+ *  @param[in] memorySize  Maximum Model Cache memory in bytes.
+ *
+ *  @see lottie_configure_model_cache_size()
+ *
+ *  @internal
+ */
+RLOTTIE_API void lottie_configure_model_cache_memory_size(size_t memorySize);
+
+/**
+ *  @brief Returns the statistics of the rlottie model cache.
+ *
+ *  @param[out] stats The statistics of the model cache.
+ *
+ *  @internal
+ */
+RLOTTIE_API void lottie_get_model_cache_stats(Lottie_Model_Cache_Stats *stats);
+
+/**
+ *  @brief Configures the number of worker threads of the rlottie pool.
+ *
+ *  @param[in] thread_count  Number of worker threads, 0 for one per
+ *                           hardware thread.
+ *
+ *  @note Must not be called while rendering.
+ *
+ *  @internal
+ */
+RLOTTIE_API void lottie_configure_thread_pool(size_t thread_count);
+
+/**
+ *  @brief Job submitted to a task executor, to be called once with its data.
+ */
+typedef void (*Lottie_Task_Job)(void *job_data);
+
+/**
+ *  @brief Host executor running the rlottie jobs on its own threads.
+ */
+typedef void (*Lottie_Task_Executor)(Lottie_Task_Job job, void *job_data,
+                                     void *user_data);
+
+/**
+ *  @brief Runs the rlottie pool on a host provided executor.
+ *
+ *  @param[in] executor         Executor running the jobs, NULL to go back
+ *                              to rlottie threads.
+ *  @param[in] user_data        Passed back to the executor.
+ *  @param[in] max_concurrency  Maximum number of jobs submitted at once,
+ *                              0 for one per hardware thread.
+ *
+ *  @note Must not be called while rendering.
+ *
+ *  @internal
+ */
+RLOTTIE_API void lottie_configure_task_executor(Lottie_Task_Executor executor,
+                                                void *user_data,
+                                                size_t max_concurrency);
+
 #ifdef __cplusplus
 }
 #endif
@@ -41,6 +41,11 @@ struct Lottie_Animation_S
     LOTMarkerList                  *mMarkerList;
 };
 
+struct Lottie_Model_S
+{
+    Model                           mModel;
+};
+
 static uint32_t _lottie_lib_ref_count = 0;
 
 RLOTTIE_API void lottie_init(void)
@@ -91,6 +96,53 @@ RLOTTIE_API Lottie_Animation_S *lottie_animation_from_data(const char *data, con
     }
 }
 
+RLOTTIE_API Lottie_Model_S *lottie_model_from_data(const char *data, const char *resourcePath)
+{
+    if (auto model = Animation::loadModelFromData(data, resourcePath) ) {
+        Lottie_Model_S *handle = new Lottie_Model_S();
+        handle->mModel = std::move(model);
+        return handle;
+    } else {
+        return nullptr;
+    }
+}
+
+RLOTTIE_API Lottie_Model_S *lottie_model_from_file(const char *path)
+{
+    if (auto model = Animation::loadModelFromFile(path) ) {
+        Lottie_Model_S *handle = new Lottie_Model_S();
+        handle->mModel = std::move(model);
+        return handle;
+    } else {
+        return nullptr;
+    }
+}
+
+RLOTTIE_API void lottie_model_destroy(Lottie_Model_S *model)
+{
+    delete model;
+}
+
+RLOTTIE_API size_t lottie_model_get_memory_size(const Lottie_Model_S *model)
+{
+    if (!model) return 0;
+
+    return modelMemorySize(model->mModel);
+}
+
+RLOTTIE_API Lottie_Animation_S *lottie_animation_from_model(const Lottie_Model_S *model)
+{
+    if (!model) return nullptr;
+
+    if (auto animation = Animation::loadFromModel(model->mModel) ) {
+        Lottie_Animation_S *handle = new Lottie_Animation_S();
+        handle->mAnimation = std::move(animation);
+        return handle;
+    } else {
+        return nullptr;
+    }
+}
+
 RLOTTIE_API void lottie_animation_destroy(Lottie_Animation_S *animation)
 {
     if (animation) {
@@ -168,6 +220,79 @@ lottie_animation_render(Lottie_Animation_S *animation,
     animation->mAnimation->renderSync(frame_number, surface);
 }
 
+RLOTTIE_API void
+lottie_animation_render_incremental(Lottie_Animation_S *animation,
+                                    size_t frame_number,
+                                    uint32_t *buffer,
+                                    size_t width,
+                                    size_t height,
+                                    size_t bytes_per_line)
+{
+    if (!animation) return;
+
+    rlottie::Surface surface(buffer, width, height, bytes_per_line);
+    surface.setIncremental(true);
+    animation->mAnimation->renderSync(frame_number, surface);
+}
+
+RLOTTIE_API void
+lottie_animation_render_clipped(Lottie_Animation_S *animation,
+                                size_t frame_number,
+                                uint32_t *buffer,
+                                size_t width,
+                                size_t height,
+                                size_t bytes_per_line,
+                                size_t clip_x,
+                                size_t clip_y,
+                                size_t clip_width,
+                                size_t clip_height,
+                                int incremental)
+{
+    if (!animation) return;
+
+    rlottie::Surface surface(buffer, width, height, bytes_per_line);
+    surface.setClipRegion(clip_x, clip_y, clip_width, clip_height);
+    surface.setIncremental(incremental != 0);
+    animation->mAnimation->renderSync(frame_number, surface);
+}
+
+RLOTTIE_API void
+lottie_animation_get_damaged_region(const Lottie_Animation_S *animation,
+                                    size_t *x, size_t *y,
+                                    size_t *width, size_t *height)
+{
+    size_t dx = 0, dy = 0, dw = 0, dh = 0;
+    if (animation) animation->mAnimation->damagedRegion(dx, dy, dw, dh);
+
+    if (x) *x = dx;
+    if (y) *y = dy;
+    if (width) *width = dw;
+    if (height) *height = dh;
+}
+
+RLOTTIE_API void
+lottie_animation_set_antialiasing(Lottie_Animation_S *animation,
+                                  int antialiasing)
+{
+    if (!animation) return;
+
+    animation->mAnimation->setAntialiasing(antialiasing != 0);
+}
+
+RLOTTIE_API void
+lottie_animation_set_render_callback(Lottie_Animation_S *animation,
+                                     void (*callback)(void *user_data),
+                                     void *user_data)
+{
+    if (!animation) return;
+
+    if (callback)
+        animation->mAnimation->setRenderCallback(
+            [callback, user_data]() { callback(user_data); });
+    else
+        animation->mAnimation->setRenderCallback({});
+}
+
 RLOTTIE_API void
 lottie_animation_render_async(Lottie_Animation_S *animation,
                               size_t frame_number,
@@ -183,6 +308,28 @@ lottie_animation_render_async(Lottie_Animation_S *animation,
     animation->mBufferRef = buffer;
 }
 
+RLOTTIE_API void
+lottie_animation_render_clipped_async(Lottie_Animation_S *animation,
+                                      size_t frame_number,
+                                      uint32_t *buffer,
+                                      size_t width,
+                                      size_t height,
+                                      size_t bytes_per_line,
+                                      size_t clip_x,
+                                      size_t clip_y,
+                                      size_t clip_width,
+                                      size_t clip_height,
+                                      int incremental)
+{
+    if (!animation) return;
+
+    rlottie::Surface surface(buffer, width, height, bytes_per_line);
+    surface.setClipRegion(clip_x, clip_y, clip_width, clip_height);
+    surface.setIncremental(incremental != 0);
+    animation->mRenderTask = animation->mAnimation->render(frame_number, surface);
+    animation->mBufferRef = buffer;
+}
+
 RLOTTIE_API uint32_t *
 lottie_animation_render_flush(Lottie_Animation_S *animation)
 {
@@ -195,6 +342,17 @@ lottie_animation_render_flush(Lottie_Animation_S *animation)
     return animation->mBufferRef;
 }
 
+RLOTTIE_API int
+lottie_animation_render_ready(Lottie_Animation_S *animation)
+{
+    if (!animation) return 1;
+
+    if (!animation->mRenderTask.valid()) return 1;
+
+    return animation->mRenderTask.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+}
+
 RLOTTIE_API void
 lottie_animation_property_override(Lottie_Animation_S *animation,
                                    const Lottie_Animation_Property type,
@@ -312,4 +470,48 @@ lottie_configure_model_cache_size(size_t cacheSize)
    rlottie::configureModelCacheSize(cacheSize);
 }
 
+RLOTTIE_API void lottie_configure_model_cache_memory_size(size_t memorySize)
+{
+   rlottie::configureModelCacheMemorySize(memorySize);
+}
+
+RLOTTIE_API void lottie_get_model_cache_stats(Lottie_Model_Cache_Stats *stats)
+{
+   if (!stats) return;
+
+   auto cacheStats = rlottie::modelCacheStats();
+   stats->hits = cacheStats.hits;
+   stats->misses = cacheStats.misses;
+   stats->evictions = cacheStats.evictions;
+   stats->entries = cacheStats.entries;
+   stats->memory_size = cacheStats.memorySize;
+}
+
+RLOTTIE_API void lottie_configure_thread_pool(size_t thread_count)
+{
+   rlottie::configureThreadPool(thread_count);
+}
+
+RLOTTIE_API void lottie_configure_task_executor(Lottie_Task_Executor executor,
+                                                void *user_data,
+                                                size_t max_concurrency)
+{
+   if (!executor) {
+      rlottie::configureTaskExecutor(nullptr, max_concurrency);
+      return;
+   }
+
+   rlottie::configureTaskExecutor(
+       [executor, user_data](std::function<void()> job) {
+          auto data = new std::function<void()>(std::move(job));
+          executor([](void *job_data) {
+                      auto job = static_cast<std::function<void()> *>(job_data);
+                      (*job)();
+                      delete job;
+                   },
+                   data, user_data);
+       },
+       max_concurrency);
+}
+
 }
@@ -23,6 +23,7 @@
 #include "lottieitem.h"
 #include "lottiemodel.h"
 #include "../../inc/rlottie.h"
+#include "../vector/vtaskqueue.h"
 
 #include <fstream>
 
@@ -34,8 +35,53 @@ RLOTTIE_API void rlottie::configureModelCacheSize(size_t cacheSize)
     internal::model::configureModelCacheSize(cacheSize);
 }
 
-struct RenderTask {
+RLOTTIE_API void rlottie::configureModelCacheMemorySize(size_t memorySize)
+{
+    internal::model::configureModelCacheMemorySize(memorySize);
+}
+
+RLOTTIE_API void rlottie::configureThreadPool(size_t threadCount)
+{
+#ifdef LOTTIE_THREAD_SUPPORT
+    VTaskScheduler::instance().configure(unsigned(threadCount), nullptr);
+#else
+    (void)threadCount;
+#endif
+}
+
+RLOTTIE_API void rlottie::configureTaskExecutor(TaskExecutor executor,
+                                                size_t       maxConcurrency)
+{
+#ifdef LOTTIE_THREAD_SUPPORT
+    if (!executor) {
+        VTaskScheduler::instance().configure(unsigned(maxConcurrency), nullptr);
+        return;
+    }
+
+    VTaskScheduler::instance().configure(
+        unsigned(maxConcurrency),
+        [executor](void (*job)(void *), void *data) {
+            executor([job, data] { job(data); });
+        });
+#else
+    (void)executor;
+    (void)maxConcurrency;
+#endif
+}
+
+RLOTTIE_API ModelCacheStats rlottie::modelCacheStats()
+{
+    return internal::model::modelCacheStats();
+}
+
+RLOTTIE_API size_t rlottie::modelMemorySize(const Model &model)
+{
+    return model ? model->memorySize() : 0;
+}
+
+struct RenderTask : public VTask {
     RenderTask() { receiver = sender.get_future(); }
+    void                  run() override;
     std::promise<Surface> sender;
     std::future<Surface>  receiver;
     AnimationImpl *       playerImpl{nullptr};
@@ -48,6 +94,7 @@ using SharedRenderTask = std::shared_ptr<RenderTask>;
 class AnimationImpl {
 public:
     void    init(std::shared_ptr<model::Composition> composition);
+    void    notifyRenderFinished();
     bool    update(size_t frameNo, const VSize &size, bool keepAspectRatio);
     VSize   size() const { return mModel->size(); }
     double  duration() const { return mModel->duration(); }
@@ -59,6 +106,15 @@ public:
     std::future<Surface> renderAsync(size_t frameNo, Surface &&surface,
                                      bool keepAspectRatio);
     const LOTLayerNode * renderTree(size_t frameNo, const VSize &size);
+    VRect                damage() const { return mRenderer->damage(); }
+    void setAntialiasing(bool antialiasing)
+    {
+        mRenderer->setAntialiasing(antialiasing);
+    }
+    void setRenderCallback(std::function<void()> callback)
+    {
+        mRenderCallback = std::move(callback);
+    }
 
     const LayerInfoList &layerInfoList() const
     {
@@ -76,6 +132,7 @@ private:
     model::Composition *                   mModel;
     SharedRenderTask                       mTask;
     std::atomic<bool>                      mRenderInProgress;
+    std::function<void()>                  mRenderCallback;
     std::unique_ptr<renderer::Composition> mRenderer{nullptr};
 };
 
@@ -132,120 +189,45 @@ void AnimationImpl::init(std::shared_ptr<model::Composition> composition)
     mRenderInProgress = false;
 }
 
-#ifdef LOTTIE_THREAD_SUPPORT
+void AnimationImpl::notifyRenderFinished()
+{
+    if (mRenderCallback) mRenderCallback();
+}
 
-#include <thread>
-#include "../vector/vtaskqueue.h"
+void RenderTask::run()
+{
+    auto result = playerImpl->render(frameNo, surface, keepAspectRatio);
+    // notify before the future is ready, the owner can destroy the player then
+    playerImpl->notifyRenderFinished();
+    sender.set_value(result);
+}
 
 /*
- * Implement a task stealing schduler to perform render task
- * As each player draws into its own buffer we can delegate this
- * task to a slave thread. The scheduler creates a threadpool depending
- * on the number of cores available in the system and does a simple fair
- * scheduling by assigning the task in a round-robin fashion. Each thread
- * in the threadpool has its own queue. once it finishes all the task on its
- * own queue it goes through rest of the queue and looks for task if it founds
- * one it steals the task from it and executes. if it couldn't find one then it
- * just waits for new task on its own queue.
+ * As each player draws into its own buffer the whole frame can be delegated
+ * to a worker of the shared VTaskScheduler pool, which also runs the
+ * rasterization and band tasks the frame spawns. The task stays owned by its
+ * AnimationImpl, the scheduler only passes the pointer around.
  */
 class RenderTaskScheduler {
-    const unsigned           _count{std::thread::hardware_concurrency()};
-    std::vector<std::thread> _threads;
-    std::vector<TaskQueue<SharedRenderTask>> _q{_count};
-    std::atomic<unsigned>                    _index{0};
-
-    void run(unsigned i)
-    {
-        while (true) {
-            bool             success = false;
-            SharedRenderTask task;
-            for (unsigned n = 0; n != _count * 2; ++n) {
-                if (_q[(i + n) % _count].try_pop(task)) {
-                    success = true;
-                    break;
-                }
-            }
-            if (!success && !_q[i].pop(task)) break;
-
-            auto result = task->playerImpl->render(task->frameNo, task->surface,
-                                                   task->keepAspectRatio);
-            task->sender.set_value(result);
-        }
-    }
-
-    RenderTaskScheduler()
-    {
-        for (unsigned n = 0; n != _count; ++n) {
-            _threads.emplace_back([&, n] { run(n); });
-        }
-
-        IsRunning = true;
-    }
-
 public:
-    static bool IsRunning;
-
     static RenderTaskScheduler &instance()
     {
         static RenderTaskScheduler singleton;
         return singleton;
     }
 
-    ~RenderTaskScheduler() { stop(); }
-
-    void stop()
-    {
-        if (IsRunning) {
-            IsRunning = false;
-
-            for (auto &e : _q) e.done();
-            for (auto &e : _threads) e.join();
-        }
-    }
-
     std::future<Surface> process(SharedRenderTask task)
     {
         auto receiver = std::move(task->receiver);
-        auto i = _index++;
-
-        for (unsigned n = 0; n != _count; ++n) {
-            if (_q[(i + n) % _count].try_push(std::move(task))) return receiver;
-        }
-
-        if (_count > 0) {
-            _q[i % _count].push(std::move(task));
-        }
-
-        return receiver;
-    }
-};
-
+#ifdef LOTTIE_THREAD_SUPPORT
+        VTaskScheduler::instance().push(task.get());
 #else
-class RenderTaskScheduler {
-public:
-    static bool IsRunning;
-
-    static RenderTaskScheduler &instance()
-    {
-        static RenderTaskScheduler singleton;
-        return singleton;
-    }
-
-    void stop() {}
-
-    std::future<Surface> process(SharedRenderTask task)
-    {
-        auto result = task->playerImpl->render(task->frameNo, task->surface,
-                                               task->keepAspectRatio);
-        task->sender.set_value(result);
-        return std::move(task->receiver);
+        task->run();
+#endif
+        return receiver;
     }
 };
 
-#endif
-
-bool RenderTaskScheduler::IsRunning{false};
-
 std::future<Surface> AnimationImpl::renderAsync(size_t    frameNo,
                                                 Surface &&surface,
                                                 bool      keepAspectRatio)
@@ -308,6 +290,40 @@ std::unique_ptr<Animation> Animation::loadFromData(std::string jsonData,
     return nullptr;
 }
 
+std::unique_ptr<Animation> Animation::loadFromModel(Model model)
+{
+    if (!model) {
+        vWarning << "model is empty";
+        return nullptr;
+    }
+
+    auto animation = std::unique_ptr<Animation>(new Animation);
+    animation->d->init(std::move(model));
+    return animation;
+}
+
+Model Animation::loadModelFromData(std::string jsonData,
+                                   const std::string &resourcePath)
+{
+    if (jsonData.empty()) {
+        vWarning << "jason data is empty";
+        return nullptr;
+    }
+
+    return model::loadFromData(std::move(jsonData), resourcePath,
+                               model::ColorFilter{});
+}
+
+Model Animation::loadModelFromFile(const std::string &path)
+{
+    if (path.empty()) {
+        vWarning << "File path is empty";
+        return nullptr;
+    }
+
+    return model::loadFromFile(path, false);
+}
+
 std::unique_ptr<Animation> Animation::loadFromFile(const std::string &path,
                                                    bool cachePolicy)
 {
@@ -371,6 +387,26 @@ void Animation::renderSync(size_t frameNo, Surface surface,
     d->render(frameNo, surface, keepAspectRatio);
 }
 
+void Animation::damagedRegion(size_t &x, size_t &y, size_t &width,
+                              size_t &height) const
+{
+    VRect damage = d->damage();
+    x = size_t(damage.x());
+    y = size_t(damage.y());
+    width = size_t(damage.width());
+    height = size_t(damage.height());
+}
+
+void Animation::setAntialiasing(bool antialiasing)
+{
+    d->setAntialiasing(antialiasing);
+}
+
+void Animation::setRenderCallback(std::function<void()> callback)
+{
+    d->setRenderCallback(std::move(callback));
+}
+
 const LayerInfoList &Animation::layers() const
 {
     return d->layerInfoList();
@@ -445,6 +481,8 @@ Surface::Surface(uint32_t *buffer, size_t width, size_t height,
 {
     mDrawArea.w = mWidth;
     mDrawArea.h = mHeight;
+    mClipArea.w = mWidth;
+    mClipArea.h = mHeight;
 }
 
 void Surface::setDrawRegion(size_t x, size_t y, size_t width, size_t height)
@@ -457,12 +495,22 @@ void Surface::setDrawRegion(size_t x, size_t y, size_t width, size_t height)
     mDrawArea.h = height;
 }
 
+void Surface::setClipRegion(size_t x, size_t y, size_t width, size_t height)
+{
+    if ((x + width > mWidth) || (y + height > mHeight)) return;
+
+    mClipArea.x = x;
+    mClipArea.y = y;
+    mClipArea.w = width;
+    mClipArea.h = height;
+}
+
 namespace {
-void lottieShutdownRenderTaskScheduler()
+void lottieShutdownTaskScheduler()
 {
-    if (RenderTaskScheduler::IsRunning) {
-        RenderTaskScheduler::instance().stop();
-    }
+#ifdef LOTTIE_THREAD_SUPPORT
+    VTaskScheduler::instance().stop();
+#endif
 }
 }  // namespace
 
@@ -472,12 +520,9 @@ void lottie_init_impl()
     // do nothing for now.
 }
 
-extern void lottieShutdownRasterTaskScheduler();
-
 void lottie_shutdown_impl()
 {
-    lottieShutdownRenderTaskScheduler();
-    lottieShutdownRasterTaskScheduler();
+    lottieShutdownTaskScheduler();
 }
 
 #ifdef LOTTIE_LOGGING_SUPPORT
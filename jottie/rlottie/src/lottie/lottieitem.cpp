@@ -23,7 +23,10 @@
 #include "lottieitem.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <functional>
 #include <iterator>
+#include "../../config.h"
 #include "lottiekeypath.h"
 #include "../vector/vbitmap.h"
 #include "../vector/vpainter.h"
@@ -72,6 +75,153 @@ static bool strokeProp(rlottie::Property prop)
     }
 }
 
+/*
+ * Large frames are split in horizontal bands which are composited
+ * concurrently. The calling thread renders bands as well, so a frame always
+ * completes even if every worker is busy with the bands of another animation.
+ */
+#ifdef LOTTIE_THREAD_SUPPORT
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include "../vector/vtaskqueue.h"
+
+class BandTaskScheduler {
+    /*
+     * one batch per frame, pushed once per helper to the shared pool. The
+     * helpers and the calling thread take bands from it until none are left.
+     * The last one holding a reference releases it, late helpers find no
+     * band to render.
+     */
+    struct Batch : public VTask {
+        std::function<void(size_t)> work;
+        size_t                      count{0};
+        std::atomic<size_t>         next{0};
+        std::atomic<size_t>         done{0};
+        std::atomic<size_t>         refs{1};
+        std::mutex                  mutex;
+        std::condition_variable     finished;
+
+        void renderBands()
+        {
+            size_t i;
+            while ((i = next++) < count) {
+                work(i);
+                if (++done == count) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finished.notify_one();
+                }
+            }
+        }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [this] { return done == count; });
+        }
+
+        void release()
+        {
+            if (--refs == 0) delete this;
+        }
+
+        void run() override
+        {
+            renderBands();
+            release();
+        }
+    };
+
+public:
+    static BandTaskScheduler &instance()
+    {
+        static BandTaskScheduler singleton;
+        return singleton;
+    }
+
+    // number of bands that can be rendered at the same time.
+    size_t concurrency() const
+    {
+        return VTaskScheduler::instance().concurrency();
+    }
+
+    void process(size_t count, std::function<void(size_t)> work)
+    {
+        auto batch = new Batch;
+        batch->work = std::move(work);
+        batch->count = count;
+
+        if (count > 1) {
+            batch->refs += count - 1;
+            for (size_t n = 1; n < count; ++n)
+                VTaskScheduler::instance().push(batch);
+        }
+
+        // bands in progress never wait on anything, block until they finish.
+        batch->renderBands();
+        batch->wait();
+        batch->release();
+    }
+};
+
+#else
+
+class BandTaskScheduler {
+public:
+    static BandTaskScheduler &instance()
+    {
+        static BandTaskScheduler singleton;
+        return singleton;
+    }
+
+    size_t concurrency() const { return 1; }
+
+    void process(size_t count, std::function<void(size_t)> work)
+    {
+        for (size_t i = 0; i < count; ++i) work(i);
+    }
+};
+
+#endif
+
+/*
+ * Splitting only pays off once the frame is big enough to amortise the mask
+ * and matte work every band repeats, so small frames stay on one thread.
+ */
+static size_t renderBandCount(const VRect &region)
+{
+    constexpr int minBandHeight = 64;
+    constexpr int minBandArea = 256 * 256;
+
+    const size_t area = size_t(region.width()) * size_t(region.height());
+    size_t count = (std::min)(size_t(region.height() / minBandHeight),
+                              area / minBandArea);
+    return (std::min)(count, BandTaskScheduler::instance().concurrency());
+}
+
+static void clearRect(VBitmap &surface, const VRect &rect)
+{
+    const size_t stride = surface.stride();
+    for (int y = rect.top(); y < rect.bottom(); ++y) {
+        std::memset(surface.data() + size_t(y) * stride +
+                        size_t(rect.left()) * sizeof(uint32_t),
+                    0, size_t(rect.width()) * sizeof(uint32_t));
+    }
+}
+
+/*
+ * Prepares an offscreen painter covering the clip area of the painter it
+ * will be composited into, using the same frame coordinates.
+ */
+static void beginOffscreen(VPainter &offscreen, VBitmap &bitmap,
+                           const VRect &clip)
+{
+    offscreen.begin(&bitmap);
+    offscreen.setDrawRegion(VRect(0, 0, clip.width(), clip.height()),
+                            VPoint(clip.x(), clip.y()));
+}
+
 static renderer::Layer *createLayerItem(model::Layer *layerData,
                                         VArenaAlloc * allocator)
 {
@@ -112,6 +262,9 @@ void renderer::Composition::setValue(const std::string &keypath,
     mHasDynamicValue = true;
     LOTKeyPath key(keypath);
     mRootLayer->resolveKeyPath(key, 0, value);
+
+    // the static layers skip their update, they must pick the value up too.
+    mRootLayer->invalidate();
 }
 
 bool renderer::Composition::update(int frameNo, const VSize &size,
@@ -148,6 +301,16 @@ bool renderer::Composition::update(int frameNo, const VSize &size,
     return true;
 }
 
+void renderer::Composition::setAntialiasing(bool antialiasing)
+{
+    if (mAntialiasing == antialiasing) return;
+
+    // the rles of the static content are kept across frames, rasterize all.
+    mAntialiasing = antialiasing;
+    mRootLayer->invalidate();
+    mCurFrameNo = -1;
+}
+
 bool renderer::Composition::render(const rlottie::Surface &surface)
 {
     mSurface.reset(reinterpret_cast<uint8_t *>(surface.buffer()),
@@ -159,18 +322,129 @@ bool renderer::Composition::render(const rlottie::Surface &surface)
      */
     VRect clip(0, 0, int(surface.drawRegionWidth()),
                int(surface.drawRegionHeight()));
+    mRasterBatch.setAntialiasing(mAntialiasing);
+    mRasterBatch.open();
     mRootLayer->preprocess(clip);
+    mRasterBatch.submit();
+
+    // sub surface area for drawing.
+    VRect region(int(surface.drawRegionPosX()), int(surface.drawRegionPosY()),
+                 int(surface.drawRegionWidth()),
+                 int(surface.drawRegionHeight()));
+
+    /*
+     * the damage is computed from the bounds of every rle of the frame, and
+     * the masks are built for the whole frame upfront as bands or a partial
+     * redraw would otherwise build them from their own clip.
+     */
+    mRasterBatch.wait();
+    mRootLayer->resolveRle(clip);
+
+    VRect damage;
+    mRootLayer->collectDamage(damage);
+
+    // a pixel of margin, so the antialiased edges of the changes are redrawn.
+    if (!damage.empty())
+        damage = VRect(damage.x() - 1, damage.y() - 1, damage.width() + 2,
+                       damage.height() + 2);
 
-    VPainter painter(&mSurface);
-    // set sub surface area for drawing.
-    painter.setDrawRegion(
-        VRect(int(surface.drawRegionPosX()), int(surface.drawRegionPosY()),
-              int(surface.drawRegionWidth()), int(surface.drawRegionHeight())));
+    // only the pixels inside the clip region of the surface are updated.
+    VRect surfaceClip(int(surface.clipRegionPosX()),
+                      int(surface.clipRegionPosY()),
+                      int(surface.clipRegionWidth()),
+                      int(surface.clipRegionHeight()));
+    VRect area = clip & surfaceClip.translated(-region.x(), -region.y());
+    bool  clipped = !surfaceClip.contains(mSurface.rect());
+
+    /*
+     * the area can be redrawn incrementally if it held the last frame, the
+     * part of the surface outside of it is only kept valid when none of the
+     * changes fell there.
+     */
+    bool  incremental = reuseSurface(surface, region) &&
+                       mValidArea.contains(area);
+    VRect lost = damage & mValidArea;
+    if (!incremental || !(lost.empty() || area.contains(lost)))
+        mValidArea = area;
+
+    damage = incremental ? (damage & area) : area;
+    mDamage = damage.translated(region.x(), region.y());
+
+    if (damage.empty()) return true;
+
+    bool partial = incremental || clipped;
+
+    size_t bands = renderBandCount(damage);
+    if (bands > 1) {
+        renderBands(damage, region, bands, partial);
+        return true;
+    }
+
+    VPainter painter;
+    painter.begin(&mSurface, !partial);
+    if (partial) clearRect(mSurface, mDamage);
+    painter.setDrawRegion(region);
+    painter.setClipRect(damage);
     mRootLayer->render(&painter, {}, {}, mSurfaceCache);
     painter.end();
     return true;
 }
 
+/*
+ * An incremental surface keeps the pixels that didn't change, which is only
+ * possible if it holds the last frame rendered by this composition.
+ */
+bool renderer::Composition::reuseSurface(const rlottie::Surface &surface,
+                                         const VRect &             region)
+{
+    bool reuse = surface.incremental() && !mHasDynamicValue &&
+                 surface.buffer() == mLastBuffer &&
+                 mSurface.size() == mLastBufferSize &&
+                 mSurface.stride() == mLastStride && region == mLastRegion;
+
+    mLastBuffer = surface.buffer();
+    mLastBufferSize = mSurface.size();
+    mLastStride = mSurface.stride();
+    mLastRegion = region;
+
+    return reuse;
+}
+
+void renderer::Composition::renderBands(const VRect &area, const VRect &region,
+                                        size_t count, bool partial)
+{
+    if (mBandSurfaceCache.size() < count) mBandSurfaceCache.resize(count);
+
+    const size_t height = size_t(mSurface.height());
+    const size_t stride = size_t(mSurface.stride());
+
+    BandTaskScheduler::instance().process(count, [&](size_t i) {
+        int top = area.top() + int(area.height() * i / count);
+        int bottom = area.top() + int(area.height() * (i + 1) / count);
+        VRect band(area.left(), top, area.width(), bottom - top);
+
+        if (partial) {
+            clearRect(mSurface, band.translated(region.x(), region.y()));
+        } else {
+            // every band clears its own rows, the first and the last one
+            // also the rows above and below the draw region.
+            size_t firstRow = (i == 0) ? 0 : size_t(region.top() + top);
+            size_t lastRow = (i + 1 == count) ? height
+                                              : size_t(region.top() + bottom);
+            if (lastRow > firstRow)
+                std::memset(mSurface.data() + firstRow * stride, 0,
+                            (lastRow - firstRow) * stride);
+        }
+
+        VPainter painter;
+        painter.begin(&mSurface, false);
+        painter.setDrawRegion(region);
+        painter.setClipRect(band);
+        mRootLayer->render(&painter, {}, {}, mBandSurfaceCache[i]);
+        painter.end();
+    });
+}
+
 void renderer::Mask::update(int frameNo, const VMatrix &parentMatrix,
                             float /*parentAlpha*/, const DirtyFlag &flag)
 {
@@ -214,6 +488,25 @@ void renderer::Mask::preprocess(const VRect &clip)
         mRasterizer.rasterize(mFinalPath, FillRule::Winding, clip);
 }
 
+VRect renderer::Layer::boundingRect()
+{
+    if (skipRendering()) return {};
+
+    VRect rect;
+    for (auto &i : renderList()) rect = rect | i->rle().boundingRect();
+    return rect;
+}
+
+void renderer::Layer::collectDamage(VRect &damage)
+{
+    VRect rect = boundingRect();
+    if (mChanged || rect != mRenderedRect)
+        damage = damage | mRenderedRect | rect;
+
+    mRenderedRect = rect;
+    mChanged = false;
+}
+
 void renderer::Layer::render(VPainter *painter, const VRle &inheritMask,
                              const VRle &matteRle, SurfaceCache &)
 {
@@ -258,6 +551,30 @@ void renderer::Layer::render(VPainter *painter, const VRle &inheritMask,
     }
 }
 
+void renderer::Layer::resolveRle(const VRect &clip)
+{
+    if (skipRendering()) return;
+
+    if (mLayerMask) mLayerMask->maskRle(clip).boundingRect();
+
+    for (auto &i : renderList()) {
+        i->rle().boundingRect();
+
+        // the brush matrix computes its type lazily as well.
+        switch (i->mBrush.type()) {
+        case VBrush::Type::LinearGradient:
+        case VBrush::Type::RadialGradient:
+            i->mBrush.mGradient->mMatrix.type();
+            break;
+        case VBrush::Type::Texture:
+            i->mBrush.mTexture->mMatrix.type();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 void renderer::LayerMask::preprocess(const VRect &clip)
 {
     for (auto &i : mMasks) {
@@ -422,6 +739,12 @@ void renderer::Layer::update(int frameNumber, const VMatrix &parentMatrix,
                            mDirtyFlag);
     }
 
+    // a precomp only tracks its own properties, its layers track theirs.
+    bool contentChanged = mLayerData->precompLayer()
+                              ? (mLayerMask && !mLayerMask->isStatic())
+                              : !isStatic();
+    if (!flag().testFlag(DirtyFlagBit::None) || contentChanged) mChanged = true;
+
     // 5. if no parent property change and layer is static then nothing to do.
     if (!mLayerData->precompLayer() && flag().testFlag(DirtyFlagBit::None) &&
         isStatic())
@@ -501,13 +824,15 @@ void renderer::CompLayer::render(VPainter *painter, const VRle &inheritMask,
         renderHelper(painter, inheritMask, matteRle, cache);
     } else {
         if (complexContent()) {
-            VSize    size = painter->clipBoundingRect().size();
+            VRect clip = painter->clipBoundingRect() & boundingRect();
+            if (clip.empty()) return;
+
             VPainter srcPainter;
-            VBitmap srcBitmap = cache.make_surface(size.width(), size.height());
-            srcPainter.begin(&srcBitmap);
+            VBitmap srcBitmap = cache.make_surface(clip.width(), clip.height());
+            beginOffscreen(srcPainter, srcBitmap, clip);
             renderHelper(&srcPainter, inheritMask, matteRle, cache);
             srcPainter.end();
-            painter->drawBitmap(VPoint(), srcBitmap,
+            painter->drawBitmap(VPoint(clip.x(), clip.y()), srcBitmap,
                                 uint8_t(combinedAlpha() * 255.0f));
             cache.release_surface(srcBitmap);
         } else {
@@ -516,6 +841,40 @@ void renderer::CompLayer::render(VPainter *painter, const VRle &inheritMask,
     }
 }
 
+VRect renderer::CompLayer::boundingRect()
+{
+    if (skipRendering()) return {};
+
+    VRect rect;
+    for (const auto &layer : mLayers) {
+        if (layer->visible()) rect = rect | layer->boundingRect();
+    }
+    return rect;
+}
+
+void renderer::CompLayer::invalidate()
+{
+    Layer::invalidate();
+
+    for (const auto &layer : mLayers) layer->invalidate();
+}
+
+void renderer::CompLayer::collectDamage(VRect &damage)
+{
+    // the layers only report their own changes, the whole precomp is damaged
+    // when its transform, opacity or masks change or it's shown or hidden.
+    VRect rect = boundingRect();
+    if (mChanged || rect.empty() != mRenderedRect.empty())
+        damage = damage | mRenderedRect | rect;
+
+    mRenderedRect = rect;
+    mChanged = false;
+
+    if (rect.empty()) return;
+
+    for (const auto &layer : mLayers) layer->collectDamage(damage);
+}
+
 void renderer::CompLayer::renderHelper(VPainter *    painter,
                                        const VRle &  inheritMask,
                                        const VRle &  matteRle,
@@ -561,19 +920,27 @@ void renderer::CompLayer::renderMatteLayer(VPainter *painter, const VRle &mask,
                                            renderer::Layer *src,
                                            SurfaceCache &   cache)
 {
-    VSize size = painter->clipBoundingRect().size();
+    // only the part of the layer covered by the matte survives, an inverted
+    // matte can only remove pixels from the layer.
+    VRect area = painter->clipBoundingRect() & layer->boundingRect();
+    if (layer->matteType() == model::MatteType::Alpha ||
+        layer->matteType() == model::MatteType::Luma) {
+        area = area & src->boundingRect();
+    }
+    if (area.empty()) return;
+
     // Decide if we can use fast matte.
     // 1. draw src layer to matte buffer
     VPainter srcPainter;
-    VBitmap  srcBitmap = cache.make_surface(size.width(), size.height());
-    srcPainter.begin(&srcBitmap);
+    VBitmap  srcBitmap = cache.make_surface(area.width(), area.height());
+    beginOffscreen(srcPainter, srcBitmap, area);
     src->render(&srcPainter, mask, matteRle, cache);
     srcPainter.end();
 
     // 2. draw layer to layer buffer
     VPainter layerPainter;
-    VBitmap  layerBitmap = cache.make_surface(size.width(), size.height());
-    layerPainter.begin(&layerBitmap);
+    VBitmap  layerBitmap = cache.make_surface(area.width(), area.height());
+    beginOffscreen(layerPainter, layerBitmap, area);
     layer->render(&layerPainter, mask, matteRle, cache);
 
     // 2.1update composition mode
@@ -592,27 +959,20 @@ void renderer::CompLayer::renderMatteLayer(VPainter *painter, const VRle &mask,
         break;
     }
 
+    // the offscreen buffers start at the top left of the matte area.
+    VRect source(0, 0, area.width(), area.height());
+
     // 2.2 update srcBuffer if the matte is luma type
     if (layer->matteType() == model::MatteType::Luma ||
         layer->matteType() == model::MatteType::LumaInv) {
-        srcBitmap.updateLuma();
-    }
-
-    auto clip = layerPainter.clipBoundingRect();
-
-    // if the layer has only one renderer then use it as the clip rect
-    // when blending 2 buffer and copy back to final buffer to avoid
-    // unnecessary pixel processing.
-    if (layer->renderList().size() == 1)
-    {
-        clip = layer->renderList()[0]->rle().boundingRect();
+        srcBitmap.updateLuma(source);
     }
 
     // 2.3 draw src buffer as mask
-    layerPainter.drawBitmap(clip, srcBitmap, clip);
+    layerPainter.drawBitmap(area, srcBitmap, source);
     layerPainter.end();
     // 3. draw the result buffer into painter
-    painter->drawBitmap(clip, layerBitmap, clip);
+    painter->drawBitmap(area, layerBitmap, source);
 
     cache.release_surface(srcBitmap);
     cache.release_surface(layerBitmap);
@@ -637,9 +997,11 @@ VRle renderer::Clipper::rle(const VRle &mask)
 {
     if (mask.empty()) return mRasterizer.rle();
 
-    mMaskedRle.clone(mask);
-    mMaskedRle &= mRasterizer.rle();
-    return mMaskedRle;
+    // the result is local as bands of a frame clip concurrently.
+    VRle maskedRle;
+    maskedRle.clone(mask);
+    maskedRle &= mRasterizer.rle();
+    return maskedRle;
 }
 
 void renderer::CompLayer::updateContent()
@@ -655,6 +1017,34 @@ void renderer::CompLayer::updateContent()
     }
 }
 
+void renderer::CompLayer::resolveRle(const VRect &clip)
+{
+    if (skipRendering()) return;
+
+    if (mLayerMask) mLayerMask->maskRle(clip).boundingRect();
+
+    if (mClipper) mClipper->mRasterizer.rle().boundingRect();
+
+    renderer::Layer *matte = nullptr;
+    for (const auto &layer : mLayers) {
+        if (layer->hasMatte()) {
+            matte = layer;
+        } else {
+            if (layer->visible()) {
+                if (matte) {
+                    if (matte->visible()) {
+                        layer->resolveRle(clip);
+                        matte->resolveRle(clip);
+                    }
+                } else {
+                    layer->resolveRle(clip);
+                }
+            }
+            matte = nullptr;
+        }
+    }
+}
+
 void renderer::CompLayer::preprocessStage(const VRect &clip)
 {
     // if layer has clipper
@@ -842,12 +1232,15 @@ void renderer::ShapeLayer::updateContent()
     if (mLayerData->hasPathOperator()) {
         mRoot->applyTrim();
     }
+
+    mDrawableListDirty = true;
 }
 
 void renderer::ShapeLayer::preprocessStage(const VRect &clip)
 {
     mDrawableList.clear();
     mRoot->renderList(mDrawableList);
+    mDrawableListDirty = false;
 
     for (auto &drawable : mDrawableList) drawable->preprocess(clip);
 }
@@ -856,8 +1249,12 @@ renderer::DrawableList renderer::ShapeLayer::renderList()
 {
     if (skipRendering()) return {};
 
-    mDrawableList.clear();
-    mRoot->renderList(mDrawableList);
+    // reuse the list built by preprocess, render only reads it.
+    if (mDrawableListDirty) {
+        mDrawableList.clear();
+        mRoot->renderList(mDrawableList);
+        mDrawableListDirty = false;
+    }
 
     if (mDrawableList.empty()) return {};
 
@@ -873,13 +1270,15 @@ void renderer::ShapeLayer::render(VPainter *painter, const VRle &inheritMask,
         Layer::render(painter, inheritMask, matteRle, cache);
     } else {
         //do offscreen rendering
-        VSize    size = painter->clipBoundingRect().size();
+        VRect clip = painter->clipBoundingRect() & boundingRect();
+        if (clip.empty()) return;
+
         VPainter srcPainter;
-        VBitmap srcBitmap = cache.make_surface(size.width(), size.height());
-        srcPainter.begin(&srcBitmap);
+        VBitmap srcBitmap = cache.make_surface(clip.width(), clip.height());
+        beginOffscreen(srcPainter, srcBitmap, clip);
         Layer::render(&srcPainter, inheritMask, matteRle, cache);
         srcPainter.end();
-        painter->drawBitmap(VPoint(), srcBitmap,
+        painter->drawBitmap(VPoint(clip.x(), clip.y()), srcBitmap,
                             uint8_t(combinedAlpha() * 255.0f));
         cache.release_surface(srcBitmap);
     }
@@ -143,7 +143,6 @@ public:
 public:
     VSize       mSize;
     VPath       mPath;
-    VRle        mMaskedRle;
     VRasterizer mRasterizer;
     bool        mRasterRequest{false};
 };
@@ -195,10 +194,20 @@ public:
     void  buildRenderTree();
     const LOTLayerNode *renderTree() const;
     bool                render(const rlottie::Surface &surface);
+    VRect               damage() const { return mDamage; }
     void                setValue(const std::string &keypath, LOTVariant &value);
+    void                setAntialiasing(bool antialiasing);
 
 private:
+    bool reuseSurface(const rlottie::Surface &surface, const VRect &region);
+    void renderBands(const VRect &area, const VRect &region, size_t count,
+                     bool partial);
+
+private:
+    // declared first, the layers' rasterizers must go before it.
+    VRasterBatch                        mRasterBatch;
     SurfaceCache                        mSurfaceCache;
+    std::vector<SurfaceCache>           mBandSurfaceCache;
     VBitmap                             mSurface;
     VMatrix                             mScaleMatrix;
     VSize                               mViewSize;
@@ -208,6 +217,14 @@ private:
     int                                 mCurFrameNo;
     bool                                mKeepAspectRatio{true};
     bool                                mHasDynamicValue{false};
+    bool                                mAntialiasing{true};
+    // target of the last render, an incremental surface must match it.
+    uint32_t *                          mLastBuffer{nullptr};
+    VSize                               mLastBufferSize;
+    size_t                              mLastStride{0};
+    VRect                               mLastRegion;
+    VRect                               mValidArea;
+    VRect                               mDamage;
 };
 
 class Layer {
@@ -224,7 +241,14 @@ public:
                         float parentAlpha);
     VMatrix      matrix(int frameNo) const;
     void         preprocess(const VRect &clip);
+    virtual void resolveRle(const VRect &clip);
     virtual DrawableList renderList() { return {}; }
+    // area touched by render(), valid once the rles are resolved.
+    virtual VRect        boundingRect();
+    // adds the area that changed since the previous call to damage.
+    virtual void         collectDamage(VRect &damage);
+    // the content is updated and rasterized again on the next update.
+    virtual void         invalidate() { mDirtyFlag = DirtyFlagBit::All; }
     virtual void         render(VPainter *painter, const VRle &mask,
                                 const VRle &matteRle, SurfaceCache &cache);
     bool                 hasMatte()
@@ -265,6 +289,8 @@ protected:
     float                      mCombinedAlpha{0.0};
     int                        mFrameNo{-1};
     DirtyFlag                  mDirtyFlag{DirtyFlagBit::All};
+    VRect                      mRenderedRect;
+    bool                       mChanged{true};
     bool                       mComplexContent{false};
     std::unique_ptr<CApiData>  mCApiData;
 };
@@ -275,6 +301,10 @@ public:
 
     void render(VPainter *painter, const VRle &mask, const VRle &matteRle,
                 SurfaceCache &cache) final;
+    VRect boundingRect() final;
+    void collectDamage(VRect &damage) final;
+    void invalidate() final;
+    void resolveRle(const VRect &clip) final;
     void buildLayerNode() final;
     bool resolveKeyPath(LOTKeyPath &keyPath, uint32_t depth,
                         LOTVariant &value) override;
@@ -328,6 +358,7 @@ protected:
     void                     updateContent() final;
     std::vector<VDrawable *> mDrawableList;
     Group *                  mRoot{nullptr};
+    bool                     mDrawableListDirty{true};
 };
 
 class NullLayer final : public Layer {
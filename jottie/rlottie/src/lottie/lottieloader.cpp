@@ -21,15 +21,19 @@
  */
 
 #include <cstring>
+#include <limits>
 #include <fstream>
 #include <sstream>
 
+#include "lottiemappedfile.h"
 #include "lottiemodel.h"
+#include "../../inc/rlottie.h"
 
 using namespace rlottie::internal;
 
 #ifdef LOTTIE_CACHE_SUPPORT
 
+#include <list>
 #include <mutex>
 #include <unordered_map>
 
@@ -47,8 +51,16 @@ public:
         if (!mcacheSize) return nullptr;
 
         auto search = mHash.find(key);
+        if (search == mHash.end()) {
+            mStats.misses++;
+            return nullptr;
+        }
 
-        return (search != mHash.end()) ? search->second : nullptr;
+        // move to the front of the list as most recently used.
+        mList.splice(mList.begin(), mList, search->second);
+        mStats.hits++;
+
+        return search->second->mModel;
     }
     void add(const std::string &key, std::shared_ptr<model::Composition> value)
     {
@@ -56,11 +68,17 @@ public:
 
         if (!mcacheSize) return;
 
-        //@TODO just remove the 1st element
-        // not the best of LRU logic
-        if (mcacheSize == mHash.size()) mHash.erase(mHash.cbegin());
+        auto search = mHash.find(key);
+        if (search != mHash.end()) erase(search);
+
+        size_t memorySize = value->memorySize();
+        if (memorySize > mcacheMemorySize) return;
 
-        mHash[key] = std::move(value);
+        evict(mcacheSize - 1, mcacheMemorySize - memorySize);
+
+        mList.push_front({key, std::move(value), memorySize});
+        mHash[key] = mList.begin();
+        mMemorySize += memorySize;
     }
 
     void configureCacheSize(size_t cacheSize)
@@ -68,15 +86,63 @@ public:
         std::lock_guard<std::mutex> guard(mMutex);
         mcacheSize = cacheSize;
 
-        if (!mcacheSize) mHash.clear();
+        evict(mcacheSize, mcacheMemorySize);
+    }
+
+    void configureCacheMemorySize(size_t memorySize)
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mcacheMemorySize = memorySize;
+
+        evict(mcacheSize, mcacheMemorySize);
+    }
+
+    rlottie::ModelCacheStats stats()
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+
+        rlottie::ModelCacheStats result = mStats;
+        result.entries = mHash.size();
+        result.memorySize = mMemorySize;
+        return result;
     }
 
 private:
+    struct Entry {
+        std::string                         mKey;
+        std::shared_ptr<model::Composition> mModel;
+        size_t                              mMemorySize;
+    };
+    using EntryList = std::list<Entry>;
+
     ModelCache() = default;
 
-    std::unordered_map<std::string, std::shared_ptr<model::Composition>> mHash;
-    std::mutex                                                           mMutex;
+    void erase(std::unordered_map<std::string, EntryList::iterator>::iterator it)
+    {
+        mMemorySize -= it->second->mMemorySize;
+        mList.erase(it->second);
+        mHash.erase(it);
+    }
+
+    // drop the least recently used entries until the cache fits the limits.
+    void evict(size_t maxCount, size_t maxMemorySize)
+    {
+        while (!mList.empty() &&
+               (mList.size() > maxCount || mMemorySize > maxMemorySize)) {
+            mMemorySize -= mList.back().mMemorySize;
+            mHash.erase(mList.back().mKey);
+            mList.pop_back();
+            mStats.evictions++;
+        }
+    }
+
+    EntryList                                              mList;
+    std::unordered_map<std::string, EntryList::iterator>   mHash;
+    std::mutex                                             mMutex;
+    rlottie::ModelCacheStats                               mStats;
+    size_t mMemorySize{0};
     size_t mcacheSize{10};
+    size_t mcacheMemorySize{std::numeric_limits<size_t>::max()};
 };
 
 #else
@@ -94,6 +160,8 @@ public:
     }
     void add(const std::string &, std::shared_ptr<model::Composition>) {}
     void configureCacheSize(size_t) {}
+    void configureCacheMemorySize(size_t) {}
+    rlottie::ModelCacheStats stats() { return {}; }
 };
 
 #endif
@@ -113,6 +181,16 @@ void model::configureModelCacheSize(size_t cacheSize)
     ModelCache::instance().configureCacheSize(cacheSize);
 }
 
+void model::configureModelCacheMemorySize(size_t memorySize)
+{
+    ModelCache::instance().configureCacheMemorySize(memorySize);
+}
+
+rlottie::ModelCacheStats model::modelCacheStats()
+{
+    return ModelCache::instance().stats();
+}
+
 std::shared_ptr<model::Composition> model::loadFromFile(const std::string &path,
                                                         bool cachePolicy)
 {
@@ -121,6 +199,16 @@ std::shared_ptr<model::Composition> model::loadFromFile(const std::string &path,
         if (obj) return obj;
     }
 
+    MappedFile mappedFile(path);
+    if (mappedFile.valid()) {
+        auto obj = internal::model::parse(mappedFile.data(), mappedFile.size(),
+                                          dirname(path));
+
+        if (obj && cachePolicy) ModelCache::instance().add(path, obj);
+
+        return obj;
+    }
+
     std::ifstream f;
     f.open(path);
 
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "lottiemappedfile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace rlottie::internal;
+
+MappedFile::MappedFile(const std::string &path)
+{
+#ifdef _WIN32
+    int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (wlen <= 0) return;
+    std::wstring wpath(size_t(wlen), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wpath[0], wlen);
+
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    LARGE_INTEGER fileSize;
+    SYSTEM_INFO   info;
+    GetSystemInfo(&info);
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 &&
+        fileSize.QuadPart % info.dwPageSize != 0) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY,
+                                            0, 0, nullptr);
+        if (mapping) {
+            mData = static_cast<char *>(
+                MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+            if (mData) mSize = size_t(fileSize.QuadPart);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    long        pageSize = sysconf(_SC_PAGESIZE);
+    if (fstat(fd, &st) == 0 && st.st_size > 0 && pageSize > 0 &&
+        st.st_size % pageSize != 0) {
+        void *data = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            mData = static_cast<char *>(data);
+            mSize = size_t(st.st_size);
+        }
+    }
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    if (!mData) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mData);
+#else
+    munmap(mData, mSize);
+#endif
+}
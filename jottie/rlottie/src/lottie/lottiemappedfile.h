@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LOTTIEMAPPEDFILE_H
+#define LOTTIEMAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace rlottie {
+
+namespace internal {
+
+/*
+ * Private copy-on-write mapping of a file, so the in-situ json parser can
+ * mutate the content without copying it and without touching the file.
+ * The content is null terminated by the zero fill of the last page, so
+ * files whose size is an exact multiple of the page size can't be mapped
+ * and the caller should fall back to read the file.
+ *
+ * The implementation lives in its own translation unit so the platform
+ * headers it needs never leak into the rest of the library.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool   valid() const { return mData != nullptr; }
+    char * data() const { return mData; }
+    size_t size() const { return mSize; }
+
+private:
+    char * mData{nullptr};
+    size_t mSize{0};
+};
+
+}  // namespace internal
+
+}  // namespace rlottie
+
+#endif  // LOTTIEMAPPEDFILE_H
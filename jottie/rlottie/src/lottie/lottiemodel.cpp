@@ -158,6 +158,18 @@ void model::Composition::updateStats()
     visitor.visit(mRootLayer);
 }
 
+size_t model::Composition::memorySize() const
+{
+    size_t size = sizeof(*this) + mArenaAlloc.allocatedSize();
+
+    for (const auto &asset : mAssets) {
+        const auto &bitmap = asset.second->mBitmap;
+        if (bitmap.valid()) size += bitmap.stride() * bitmap.height();
+    }
+
+    return size;
+}
+
 VMatrix model::Repeater::Transform::matrix(int frameNo, float multiplier) const
 {
     VPointF scale = mScale.value(frameNo) / 100.f;
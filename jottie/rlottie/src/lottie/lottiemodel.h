@@ -43,6 +43,8 @@ V_USE_NAMESPACE
 
 namespace rlottie {
 
+struct ModelCacheStats;
+
 namespace internal {
 
 using Marker = std::tuple<std::string, int, int>;
@@ -547,6 +549,7 @@ public:
     VSize  size() const { return mSize; }
     void   processRepeaterObjects();
     void   updateStats();
+    size_t memorySize() const;
 
 public:
     struct Stats {
@@ -1125,6 +1128,10 @@ using ColorFilter = std::function<void(float &, float &, float &)>;
 
 void configureModelCacheSize(size_t cacheSize);
 
+void configureModelCacheMemorySize(size_t memorySize);
+
+rlottie::ModelCacheStats modelCacheStats();
+
 std::shared_ptr<model::Composition> loadFromFile(const std::string &filePath,
                                                  bool cachePolicy);
 
@@ -321,6 +321,7 @@ typedef struct gray_TWorker_ {
 
     SW_FT_Raster_Span_Func render_span;
     void*                  render_span_data;
+    int                    aliased;
 
     int band_size;
     int band_shoot;
@@ -870,6 +871,9 @@ static void gray_hline(RAS_ARG_ TCoord x, TCoord y, TPos area, TCoord acount)
         if (coverage >= 256) coverage = 255;
     }
 
+    /* monochrome rendering keeps the pixels at least half covered */
+    if (ras.aliased) coverage = coverage >= 128 ? 255 : 0;
+
     y += (TCoord)ras.min_ey;
     x += (TCoord)ras.min_ex;
 
@@ -1355,9 +1359,8 @@ static int gray_raster_render(gray_PRaster               raster,
     if (outline->n_points != outline->contours[outline->n_contours - 1] + 1)
         return SW_FT_THROW(Invalid_Outline);
 
-    /* this version does not support monochrome rendering */
-    if (!(params->flags & SW_FT_RASTER_FLAG_AA))
-        return SW_FT_THROW(Invalid_Mode);
+    /* monochrome rendering thresholds the coverage of the gray spans */
+    ras.aliased = !(params->flags & SW_FT_RASTER_FLAG_AA);
 
     if (params->flags & SW_FT_RASTER_FLAG_CLIP)
         ras.clip_box = params->clip_box;
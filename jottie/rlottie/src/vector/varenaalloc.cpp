@@ -129,6 +129,7 @@ void VArenaAlloc::ensureSpace(uint32_t size, uint32_t alignment) {
     }
 
     char* newBlock = new char[allocationSize];
+    fHeapAllocatedSize += allocationSize;
 
     auto previousDtor = fDtorCursor;
     fCursor = newBlock;
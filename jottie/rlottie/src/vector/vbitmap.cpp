@@ -38,7 +38,13 @@ void VBitmap::Impl::reset(size_t width, size_t height, VBitmap::Format format)
     mDepth = depth(format);
     mStride = ((mWidth * mDepth + 31) >> 5)
                   << 2;  // bytes per scanline (must be multiple of 4)
-    mOwnData = std::make_unique<uint8_t[]>(mStride * mHeight);
+
+    // offscreen surfaces change size every frame, keep the larger buffer.
+    size_t size = size_t(mStride) * mHeight;
+    if (!mOwnData || mCapacity < size) {
+        mOwnData = std::make_unique<uint8_t[]>(size);
+        mCapacity = size;
+    }
 }
 
 void VBitmap::Impl::reset(uint8_t *data, size_t width, size_t height,
@@ -51,6 +57,7 @@ void VBitmap::Impl::reset(uint8_t *data, size_t width, size_t height,
     mFormat = format;
     mDepth = depth(format);
     mOwnData = nullptr;
+    mCapacity = 0;
 }
 
 uint8_t VBitmap::Impl::depth(VBitmap::Format format)
@@ -75,33 +82,17 @@ void VBitmap::Impl::fill(uint32_t /*pixel*/)
     //@TODO
 }
 
-void VBitmap::Impl::updateLuma()
+void VBitmap::Impl::updateLuma(const VRect &area)
 {
     if (mFormat != VBitmap::Format::ARGB32_Premultiplied) return;
+
+    VRect region = area & rect();
+    if (region.empty()) return;
+
     auto dataPtr = data();
-    for (uint32_t col = 0; col < mHeight; col++) {
-        uint32_t *pixel = (uint32_t *)(dataPtr + mStride * col);
-        for (uint32_t row = 0; row < mWidth; row++) {
-            int alpha = vAlpha(*pixel);
-            if (alpha == 0) {
-                pixel++;
-                continue;
-            }
-
-            int red = vRed(*pixel);
-            int green = vGreen(*pixel);
-            int blue = vBlue(*pixel);
-
-            if (alpha != 255) {
-                // un multiply
-                red = (red * 255) / alpha;
-                green = (green * 255) / alpha;
-                blue = (blue * 255) / alpha;
-            }
-            int luminosity = int(0.299f * red + 0.587f * green + 0.114f * blue);
-            *pixel = luminosity << 24;
-            pixel++;
-        }
+    for (int y = region.top(); y < region.bottom(); y++) {
+        uint32_t *pixel = (uint32_t *)(dataPtr + mStride * y) + region.left();
+        convertToLuma(pixel, region.width());
     }
 }
 
@@ -210,10 +201,11 @@ void VBitmap::fill(uint32_t pixel)
  * NOTE: this api has its own special usecase
  * make sure you know what you are doing before using
  * this api.
+ * Only the pixels inside area are converted.
  */
-void VBitmap::updateLuma()
+void VBitmap::updateLuma(const VRect &area)
 {
-    if (mImpl) mImpl->updateLuma();
+    if (mImpl) mImpl->updateLuma(area);
 }
 
 V_END_NAMESPACE
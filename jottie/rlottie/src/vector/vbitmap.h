@@ -55,7 +55,7 @@ public:
     VRect           rect() const;
     VSize           size() const;
     void            fill(uint32_t pixel);
-    void    updateLuma();
+    void    updateLuma(const VRect &area);
 private:
     struct Impl {
         std::unique_ptr<uint8_t[]> mOwnData{nullptr};
@@ -63,6 +63,7 @@ private:
         uint32_t                   mWidth{0};
         uint32_t                   mHeight{0};
         uint32_t                   mStride{0};
+        size_t                     mCapacity{0};
         uint8_t                    mDepth{0};
         VBitmap::Format mFormat{VBitmap::Format::Invalid};
 
@@ -86,7 +87,7 @@ private:
         void reset(size_t, size_t, VBitmap::Format);
         static uint8_t depth(VBitmap::Format format);
         void fill(uint32_t);
-        void updateLuma();
+        void updateLuma(const VRect &area);
     };
 
     rc_ptr<Impl> mImpl;
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VCPU_H
+#define VCPU_H
+
+#include "../../config.h"
+
+#if defined(LOTTIE_SIMD_DISPATCH_SUPPORT) &&                      \
+    (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+     defined(_M_IX86))
+#define V_CPU_DISPATCH_X86 1
+#endif
+
+#ifdef V_CPU_DISPATCH_X86
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * Kernels for instruction sets above the compile time baseline are built
+ * with a per function target, they must only run once vCpuFeatures() has
+ * reported support for them.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define V_TARGET_AVX2 __attribute__((target("avx2")))
+#define V_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw")))
+#else
+#define V_TARGET_AVX2
+#define V_TARGET_AVX512
+#endif
+
+struct VCpuFeatures {
+    bool avx2{false};
+    bool avx512bw{false};
+};
+
+inline const VCpuFeatures &vCpuFeatures()
+{
+    static const VCpuFeatures features = [] {
+        VCpuFeatures f;
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return f;
+
+        __cpuid(info, 1);
+        // the OS has to save the wide registers on context switches.
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave) return f;
+        unsigned long long xcr0 = _xgetbv(0);
+        bool ymm = (xcr0 & 0x6) == 0x6;
+        bool zmm = (xcr0 & 0xe6) == 0xe6;
+
+        __cpuidex(info, 7, 0);
+        f.avx2 = ymm && (info[1] & (1 << 5)) != 0;
+        f.avx512bw = f.avx2 && zmm && (info[1] & (1 << 16)) != 0 &&
+                     (info[1] & (1 << 30)) != 0;
+#else
+        __builtin_cpu_init();
+        f.avx2 = __builtin_cpu_supports("avx2");
+        f.avx512bw = f.avx2 && __builtin_cpu_supports("avx512f") &&
+                     __builtin_cpu_supports("avx512bw");
+#endif
+        return f;
+    }();
+    return features;
+}
+
+#endif  // V_CPU_DISPATCH_X86
+
+#endif  // VCPU_H
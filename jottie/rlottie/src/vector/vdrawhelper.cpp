@@ -209,8 +209,6 @@ void VSpanData::init(VRasterBuffer *image)
  *
  */
 
-#define FIXPT_BITS 8
-#define FIXPT_SIZE (1 << FIXPT_BITS)
 static inline void getLinearGradientValues(LinearGradientValues *v,
                                            const VSpanData *     data)
 {
@@ -242,43 +240,18 @@ static inline void getRadialGradientValues(RadialGradientValues *v,
     v->extended = !vIsZero(gradient.radial.fradius) || v->a <= 0;
 }
 
-static inline int gradientClamp(const VGradientData *grad, int ipos)
+/*
+ * The fetchers derive every position from column 0 of the row instead of
+ * the first pixel of the span, so a pixel gets the same colour wherever its
+ * span starts, and a partial redraw matches a full one.
+ */
+static int spanRowEnd(const VSpanData *data, int x, int length)
 {
-    int limit;
-
-    if (grad->mSpread == VGradient::Spread::Repeat) {
-        ipos = ipos % VGradient::colorTableSize;
-        ipos = ipos < 0 ? VGradient::colorTableSize + ipos : ipos;
-    } else if (grad->mSpread == VGradient::Spread::Reflect) {
-        limit = VGradient::colorTableSize * 2;
-        ipos = ipos % limit;
-        ipos = ipos < 0 ? limit + ipos : ipos;
-        ipos = ipos >= VGradient::colorTableSize ? limit - 1 - ipos : ipos;
-    } else {
-        if (ipos < 0)
-            ipos = 0;
-        else if (ipos >= VGradient::colorTableSize)
-            ipos = VGradient::colorTableSize - 1;
-    }
-    return ipos;
+    return (std::max)(x + length, data->mDrawableSize.width());
 }
 
-static uint32_t gradientPixelFixed(const VGradientData *grad, int fixed_pos)
-{
-    int ipos = (fixed_pos + (FIXPT_SIZE / 2)) >> FIXPT_BITS;
-
-    return grad->mColorTable[gradientClamp(grad, ipos)];
-}
-
-static inline uint32_t gradientPixel(const VGradientData *grad, float pos)
-{
-    int ipos = (int)(pos * (VGradient::colorTableSize - 1) + (float)(0.5));
-
-    return grad->mColorTable[gradientClamp(grad, ipos)];
-}
-
-void fetch_linear_gradient(uint32_t *buffer, const Operator *op,
-                           const VSpanData *data, int y, int x, int length)
+static void fetch_linear_span(uint32_t *buffer, const Operator *op,
+                              const VSpanData *data, int y, int x, int length)
 {
     float                t, inc;
     const VGradientData *gradient = &data->mGradient;
@@ -288,10 +261,8 @@ void fetch_linear_gradient(uint32_t *buffer, const Operator *op,
     if (op->linear.l == 0) {
         t = inc = 0;
     } else {
-        rx = data->m21 * (y + float(0.5)) + data->m11 * (x + float(0.5)) +
-             data->dx;
-        ry = data->m22 * (y + float(0.5)) + data->m12 * (x + float(0.5)) +
-             data->dy;
+        rx = data->m21 * (y + float(0.5)) + data->m11 * float(0.5) + data->dx;
+        ry = data->m22 * (y + float(0.5)) + data->m12 * float(0.5) + data->dy;
         t = op->linear.dx * rx + op->linear.dy * ry + op->linear.off;
         inc = op->linear.dx * data->m11 + op->linear.dy * data->m12;
         affine = !data->m13 && !data->m23;
@@ -302,89 +273,104 @@ void fetch_linear_gradient(uint32_t *buffer, const Operator *op,
         }
     }
 
-    const uint32_t *end = buffer + length;
     if (affine) {
         if (inc > float(-1e-5) && inc < float(1e-5)) {
             memfill32(buffer, gradientPixelFixed(gradient, int(t * FIXPT_SIZE)),
                       length);
         } else {
-            if (t + inc * length < float(INT_MAX >> (FIXPT_BITS + 1)) &&
-                t + inc * length > float(INT_MIN >> (FIXPT_BITS + 1))) {
+            const float tEnd = t + inc * spanRowEnd(data, x, length);
+            const float limit = float(INT_MAX >> (FIXPT_BITS + 1));
+            if (t < limit && t > -limit && tEnd < limit && tEnd > -limit) {
                 // we can use fixed point math
-                int t_fixed = int(t * FIXPT_SIZE);
-                int inc_fixed = int(inc * FIXPT_SIZE);
-                while (buffer < end) {
-                    *buffer = gradientPixelFixed(gradient, t_fixed);
-                    t_fixed += inc_fixed;
-                    ++buffer;
-                }
+                const int fixedInc = int(inc * FIXPT_SIZE);
+                RenderTable.linearGradient()(buffer, length, gradient,
+                                             int(t * FIXPT_SIZE) + x * fixedInc,
+                                             fixedInc);
             } else {
                 // we have to fall back to float math
-                while (buffer < end) {
-                    *buffer =
-                        gradientPixel(gradient, t / VGradient::colorTableSize);
-                    t += inc;
-                    ++buffer;
+                for (int i = 0; i < length; ++i) {
+                    buffer[i] = gradientPixel(
+                        gradient,
+                        (t + inc * float(x + i)) / VGradient::colorTableSize);
                 }
             }
         }
     } else {  // fall back to float math here as well
-        float rw = data->m23 * (y + float(0.5)) + data->m13 * (x + float(0.5)) +
+        float rw = data->m23 * (y + float(0.5)) + data->m13 * float(0.5) +
                    data->m33;
-        while (buffer < end) {
-            float xt = rx / rw;
-            float yt = ry / rw;
+        for (int i = 0; i < length; ++i) {
+            const float column = float(x + i);
+            float       w = rw + data->m13 * column;
+            if (!w) w += data->m13;
+
+            float xt = (rx + data->m11 * column) / w;
+            float yt = (ry + data->m12 * column) / w;
             t = (op->linear.dx * xt + op->linear.dy * yt) + op->linear.off;
 
-            *buffer = gradientPixel(gradient, t);
-            rx += data->m11;
-            ry += data->m12;
-            rw += data->m13;
-            if (!rw) {
-                rw += data->m13;
-            }
-            ++buffer;
+            buffer[i] = gradientPixel(gradient, t);
         }
     }
 }
 
-static inline float radialDeterminant(float a, float b, float c)
+/*
+ * A gradient that only changes along x has the same colours on every row,
+ * they are fetched once per brush and copied from then on.
+ */
+static bool isColumnGradient(const Operator *op, const VSpanData *data)
 {
-    return (b * b) - (4 * a * c);
-}
+    if (op->linear.l == 0 || data->m13 || data->m23) return false;
 
-static void fetch(uint32_t *buffer, uint32_t *end, const Operator *op,
-                  const VSpanData *data, float det, float delta_det,
-                  float delta_delta_det, float b, float delta_b)
-{
-    if (op->radial.extended) {
-        while (buffer < end) {
-            uint32_t result = 0;
-            if (det >= 0) {
-                float w = std::sqrt(det) - b;
-                if (data->mGradient.radial.fradius + op->radial.dr * w >= 0)
-                    result = gradientPixel(&data->mGradient, w);
-            }
+    float inc = op->linear.dx * data->m11 + op->linear.dy * data->m12;
+    float incY = op->linear.dx * data->m21 + op->linear.dy * data->m22;
+    inc *= (VGradient::colorTableSize - 1);
+    incY *= (VGradient::colorTableSize - 1);
 
-            *buffer = result;
+    // a constant colour per row is already a plain fill.
+    return (inc <= float(-1e-5) || inc >= float(1e-5)) &&
+           (incY > float(-1e-5) && incY < float(1e-5));
+}
 
-            det += delta_det;
-            delta_det += delta_delta_det;
-            b += delta_b;
+static const uint32_t *gradientRow(const Operator *op, const VSpanData *data,
+                                   int y, int x, int length)
+{
+    auto &row = data->mGradientRow;
+
+    int begin = row.mBegin;
+    int end = row.mEnd;
+    if (begin == end) begin = end = x;
+
+    int newBegin = (std::min)(begin, x);
+    int newEnd = (std::max)(end, x + length);
+    if (size_t(newEnd) > row.mPixels.size()) row.mPixels.resize(size_t(newEnd));
+
+    uint32_t *pixels = row.mPixels.data();
+    if (newBegin < begin)
+        fetch_linear_span(pixels + newBegin, op, data, y, newBegin,
+                          begin - newBegin);
+    if (newEnd > end)
+        fetch_linear_span(pixels + end, op, data, y, end, newEnd - end);
+
+    row.mBegin = newBegin;
+    row.mEnd = newEnd;
+    return pixels + x;
+}
 
-            ++buffer;
-        }
+void fetch_linear_gradient(uint32_t *buffer, const Operator *op,
+                           const VSpanData *data, int y, int x, int length)
+{
+    if (x >= 0 && isColumnGradient(op, data)) {
+        memcpy(buffer, gradientRow(op, data, y, x, length),
+               size_t(length) * sizeof(uint32_t));
     } else {
-        while (buffer < end) {
-            *buffer++ = gradientPixel(&data->mGradient, std::sqrt(det) - b);
-
-            det += delta_det;
-            delta_det += delta_delta_det;
-            b += delta_b;
-        }
+        fetch_linear_span(buffer, op, data, y, x, length);
     }
 }
 
+static inline float radialDeterminant(float a, float b, float c)
+{
+    return (b * b) - (4 * a * c);
+}
+
 void fetch_radial_gradient(uint32_t *buffer, const Operator *op,
                            const VSpanData *data, int y, int x, int length)
 {
@@ -394,13 +380,10 @@ void fetch_radial_gradient(uint32_t *buffer, const Operator *op,
         return;
     }
 
-    float rx =
-        data->m21 * (y + float(0.5)) + data->dx + data->m11 * (x + float(0.5));
-    float ry =
-        data->m22 * (y + float(0.5)) + data->dy + data->m12 * (x + float(0.5));
+    float rx = data->m21 * (y + float(0.5)) + data->dx + data->m11 * float(0.5);
+    float ry = data->m22 * (y + float(0.5)) + data->dy + data->m12 * float(0.5);
     bool affine = !data->m13 && !data->m23;
 
-    uint32_t *end = buffer + length;
     if (affine) {
         rx -= data->mGradient.radial.fx;
         ry -= data->mGradient.radial.fy;
@@ -438,19 +421,26 @@ void fetch_radial_gradient(uint32_t *buffer, const Operator *op,
         const float delta_delta_det =
             (delta_b_delta_b + 4 * op->radial.a * delta_rx_plus_ry) * inv_a;
 
-        fetch(buffer, end, op, data, det, delta_det, delta_delta_det, b,
-              delta_b);
+        // the forward differences from column 0 as a polynomial of the
+        // column, so any column is computed without stepping to it.
+        RenderTable.radialGradient()(buffer, x, length, op, &data->mGradient,
+                                     det, delta_det - delta_delta_det / 2,
+                                     delta_delta_det / 2, b, delta_b);
     } else {
         float rw = data->m23 * (y + float(0.5)) + data->m33 +
-                   data->m13 * (x + float(0.5));
+                   data->m13 * float(0.5);
 
-        while (buffer < end) {
-            if (rw == 0) {
-                *buffer = 0;
+        for (int i = 0; i < length; ++i) {
+            const float column = float(x + i);
+            const float w = rw + data->m13 * column;
+            if (w == 0) {
+                buffer[i] = 0;
             } else {
-                float invRw = 1 / rw;
-                float gx = rx * invRw - data->mGradient.radial.fx;
-                float gy = ry * invRw - data->mGradient.radial.fy;
+                float invRw = 1 / w;
+                float gx = (rx + data->m11 * column) * invRw -
+                           data->mGradient.radial.fx;
+                float gy = (ry + data->m12 * column) * invRw -
+                           data->mGradient.radial.fy;
                 float b = 2 * (op->radial.dr * data->mGradient.radial.fradius +
                                gx * op->radial.dx + gy * op->radial.dy);
                 float det = radialDeterminant(
@@ -469,14 +459,8 @@ void fetch_radial_gradient(uint32_t *buffer, const Operator *op,
                         result = gradientPixel(&data->mGradient, s);
                 }
 
-                *buffer = result;
+                buffer[i] = result;
             }
-
-            rx += data->m11;
-            ry += data->m12;
-            rw += data->m13;
-
-            ++buffer;
         }
     }
 }
@@ -574,6 +558,12 @@ static constexpr inline uint8_t alpha_mul(uint8_t a, uint8_t b)
     return ((a * b) >> 8);
 }
 
+static inline int toFixed(float v)
+{
+    // positions beyond the texture clamp to its edge anyway.
+    return int(clamp(v, -32000.0f, 32000.0f) * 65536);
+}
+
 static void blend_image_xform(size_t size, const VRle::Span *array,
                               void *userData)
 {
@@ -588,18 +578,39 @@ static void blend_image_xform(size_t size, const VRle::Span *array,
 
     Operator op = getOperator(data);
 
+    const auto bilinear = RenderTable.bilinearTexture();
+    const int  fdx = toFixed(data->m11);
+    const int  fdy = toFixed(data->m12);
+
     process_in_chunk(
         array, size,
         [&](uint32_t *scratch, size_t x, size_t y, size_t len, uint8_t cov) {
-            const auto  coverage = (cov * src.alpha()) >> 8;
-            const float xfactor = y * data->m21 + data->dx + data->m11;
-            const float yfactor = y * data->m22 + data->dy + data->m12;
-            for (size_t i = 0; i < len; i++) {
-                const float fx = (x + i) * data->m11 + xfactor;
-                const float fy = (x + i) * data->m12 + yfactor;
-                const int   px = clamp(int(fx), src.left, src.right);
-                const int   py = clamp(int(fy), src.top, src.bottom);
-                scratch[i] = src.pixel(px, py);
+            const auto coverage = (cov * src.alpha()) >> 8;
+
+            // sample at the pixel centres, between the 4 nearest texels,
+            // stepping from column 0 like the gradients do.
+            const float cy = y + 0.5f;
+            const float fx =
+                data->m21 * cy + data->m11 * 0.5f + data->dx - 0.5f;
+            const float fy =
+                data->m22 * cy + data->m12 * 0.5f + data->dy - 0.5f;
+            const int   end = spanRowEnd(data, (int)x, (int)len);
+            const float ex = fx + data->m11 * end;
+            const float ey = fy + data->m12 * end;
+
+            if (data->fast_matrix && std::fabs(fx) < 32000 &&
+                std::fabs(fy) < 32000 && std::fabs(ex) < 32000 &&
+                std::fabs(ey) < 32000) {
+                // the whole row fits fixed point stepping.
+                bilinear(scratch, (int)len, &src, toFixed(fx) + (int)x * fdx,
+                         toFixed(fy) + (int)x * fdy, fdx, fdy);
+            } else {
+                for (size_t i = 0; i < len; i++) {
+                    const float column = float(x + i);
+                    scratch[i] = textureBilinearPixel(
+                        &src, toFixed(fx + data->m11 * column),
+                        toFixed(fy + data->m12 * column));
+                }
             }
             op.func(data->buffer((int)x, (int)y), (int)len, scratch, coverage);
         });
@@ -658,6 +669,7 @@ void VSpanData::setup(const VBrush &brush, BlendMode /*mode*/, int /*alpha*/)
         break;
     case VBrush::Type::LinearGradient: {
         mType = VSpanData::Type::LinearGradient;
+        mGradientRow.mBegin = mGradientRow.mEnd = 0;
         mColorTable = VGradientCache::instance().getBuffer(*brush.mGradient);
         mGradient.mColorTable = mColorTable->buffer32;
         mGradient.mColorTableAlpha = mColorTable->alpha;
@@ -754,6 +766,11 @@ void VSpanData::updateSpanFunc()
     }
 }
 
+void convertToLuma(uint32_t *buffer, int length)
+{
+    RenderTable.lumaMatte()(buffer, length);
+}
+
 #if !defined(__SSE2__) && !defined(__ARM_NEON__)
 void memfill32(uint32_t *dest, uint32_t value, int length)
 {
@@ -23,8 +23,10 @@
 #ifndef VDRAWHELPER_H
 #define VDRAWHELPER_H
 
+#include <cmath>
 #include <memory>
 #include <array>
+#include <vector>
 #include "assert.h"
 #include "vbitmap.h"
 #include "vbrush.h"
@@ -34,6 +36,8 @@
 V_USE_NAMESPACE
 
 struct VSpanData;
+struct VGradientData;
+struct VTextureData;
 struct Operator;
 
 struct RenderFunc
@@ -56,6 +60,44 @@ struct RenderFunc
     };
 };
 
+/*
+ * Inner loops of the gradient fetchers, the span start is computed by the
+ * caller.
+ */
+struct GradientFunc
+{
+    // fixed point position t of the first pixel, advancing by inc.
+    using Linear = void (*)(uint32_t *buffer, int length,
+                            const VGradientData *grad, int t, int inc);
+    // position sqrt(det) - b of the columns x to x + length, evaluated for
+    // column n as det + n * (delta_det + n * delta_delta_det) and
+    // b + n * delta_b, so a pixel doesn't depend on where its span starts.
+    using Radial = void (*)(uint32_t *buffer, int x, int length,
+                            const Operator *op, const VGradientData *grad,
+                            float det, float delta_det, float delta_delta_det,
+                            float b, float delta_b);
+};
+
+/*
+ * Bilinear texture sampler, positions are 16.16 fixed point and advance by
+ * fdx, fdy per pixel.
+ */
+struct TextureFunc
+{
+    using Bilinear = void (*)(uint32_t *buffer, int length,
+                              const VTextureData *tex, int fx, int fy, int fdx,
+                              int fdy);
+};
+
+/*
+ * Turns premultiplied pixels into a luma matte, the luminosity is stored in
+ * the alpha channel.
+ */
+struct MatteFunc
+{
+    using Luma = void (*)(uint32_t *buffer, int length);
+};
+
 class RenderFuncTable
 {
 public:
@@ -68,9 +110,15 @@ public:
     {
         return srcTable[uint32_t(mode)].src_;
     }
+    GradientFunc::Linear linearGradient() const { return linearFunc; }
+    GradientFunc::Radial radialGradient() const { return radialFunc; }
+    TextureFunc::Bilinear bilinearTexture() const { return bilinearFunc; }
+    MatteFunc::Luma       lumaMatte() const { return lumaFunc; }
 private:
     void neon();
     void sse();
+    void avx2();
+    void avx512();
     void updateColor(BlendMode mode, RenderFunc::Color f)
     {
         colorTable[uint32_t(mode)] = {RenderFunc::Type::Color, f};
@@ -79,9 +127,26 @@ private:
     {
         srcTable[uint32_t(mode)] = {RenderFunc::Type::Src, f};
     }
+    void updateGradient(GradientFunc::Linear linear, GradientFunc::Radial radial)
+    {
+        linearFunc = linear;
+        radialFunc = radial;
+    }
+    void updateTexture(TextureFunc::Bilinear bilinear)
+    {
+        bilinearFunc = bilinear;
+    }
+    void updateMatte(MatteFunc::Luma luma)
+    {
+        lumaFunc = luma;
+    }
 private:
     std::array<RenderFunc, uint32_t(BlendMode::Last)> colorTable;
     std::array<RenderFunc, uint32_t(BlendMode::Last)> srcTable;
+    GradientFunc::Linear                              linearFunc;
+    GradientFunc::Radial                              radialFunc;
+    TextureFunc::Bilinear                             bilinearFunc;
+    MatteFunc::Luma                                   lumaFunc;
 };
 
 typedef void (*SourceFetchProc)(uint32_t *buffer, const Operator *o,
@@ -91,6 +156,10 @@ typedef void (*ProcessRleSpan)(size_t count, const VRle::Span *spans,
                                void *userData);
 
 extern void memfill32(uint32_t *dest, uint32_t value, int count);
+extern void convertToLuma(uint32_t *buffer, int count);
+
+// (c * unpremultiplyTable[a]) >> 16 == c * 255 / a for any c, a <= 255.
+extern const std::array<uint32_t, 256> unpremultiplyTable;
 
 struct LinearGradientValues {
     float dx;
@@ -169,6 +238,59 @@ struct VGradientData {
     bool            mColorTableAlpha;
 };
 
+#define FIXPT_BITS 8
+#define FIXPT_SIZE (1 << FIXPT_BITS)
+
+static inline int gradientClamp(const VGradientData *grad, int ipos)
+{
+    int limit;
+
+    if (grad->mSpread == VGradient::Spread::Repeat) {
+        ipos = ipos % VGradient::colorTableSize;
+        ipos = ipos < 0 ? VGradient::colorTableSize + ipos : ipos;
+    } else if (grad->mSpread == VGradient::Spread::Reflect) {
+        limit = VGradient::colorTableSize * 2;
+        ipos = ipos % limit;
+        ipos = ipos < 0 ? limit + ipos : ipos;
+        ipos = ipos >= VGradient::colorTableSize ? limit - 1 - ipos : ipos;
+    } else {
+        if (ipos < 0)
+            ipos = 0;
+        else if (ipos >= VGradient::colorTableSize)
+            ipos = VGradient::colorTableSize - 1;
+    }
+    return ipos;
+}
+
+static inline uint32_t gradientPixelFixed(const VGradientData *grad,
+                                          int                  fixed_pos)
+{
+    int ipos = (fixed_pos + (FIXPT_SIZE / 2)) >> FIXPT_BITS;
+
+    return grad->mColorTable[gradientClamp(grad, ipos)];
+}
+
+static inline uint32_t gradientPixel(const VGradientData *grad, float pos)
+{
+    int ipos = (int)(pos * (VGradient::colorTableSize - 1) + (float)(0.5));
+
+    return grad->mColorTable[gradientClamp(grad, ipos)];
+}
+
+static inline uint32_t gradientRadialPixel(const Operator *     op,
+                                           const VGradientData *grad,
+                                           float det, float b)
+{
+    if (!op->radial.extended) return gradientPixel(grad, std::sqrt(det) - b);
+
+    if (det < 0) return 0;
+
+    float w = std::sqrt(det) - b;
+    if (grad->radial.fradius + op->radial.dr * w < 0) return 0;
+
+    return gradientPixel(grad, w);
+}
+
 struct VTextureData : public VRasterBuffer {
     uint32_t pixel(int x, int y) const { return *pixelRef(x, y); };
     uint8_t  alpha() const { return mAlpha; }
@@ -197,17 +319,22 @@ struct VSpanData {
                int alpha = 255);
     void setupMatrix(const VMatrix &matrix);
 
-    VRect clipRect() const
-    {
-        return VRect(0, 0, mDrawableSize.width(), mDrawableSize.height());
-    }
+    VRect clipRect() const { return mClipRect; }
 
-    void setDrawRegion(const VRect &region)
+    /*
+     * maps the logical point origin to the top left of region, so a surface
+     * holding only part of the frame can be drawn with frame coordinates.
+     */
+    void setDrawRegion(const VRect &region, const VPoint &origin = VPoint())
     {
-        mOffset = VPoint(region.left(), region.top());
+        mOffset = VPoint(region.left() - origin.x(), region.top() - origin.y());
         mDrawableSize = VSize(region.width(), region.height());
+        mClipRect = VRect(origin.x(), origin.y(), region.width(),
+                          region.height());
     }
 
+    void setClipRect(const VRect &clip) { mClipRect = mClipRect & clip; }
+
     uint32_t *buffer(int x, int y) const
     {
         return mRasterBuffer->pixelRef(x + mOffset.x(), y + mOffset.y());
@@ -223,10 +350,19 @@ struct VSpanData {
     std::shared_ptr<const VColorTable> mColorTable{nullptr};
     VPoint                             mOffset;  // offset to the subsurface
     VSize                              mDrawableSize;  // suburface size
+    VRect                              mClipRect;  // drawable area in frame space
     uint32_t                           mSolid;
     VGradientData                      mGradient;
     VTextureData                       mTexture;
 
+    // colours of a gradient that only changes along x, see gradientRow().
+    struct GradientRow {
+        std::vector<uint32_t> mPixels;
+        int                   mBegin{0};
+        int                   mEnd{0};
+    };
+    mutable GradientRow                mGradientRow;
+
     float m11, m12, m13, m21, m22, m23, m33, dx, dy;  // inverse xform matrix
     bool  fast_matrix{true};
     VMatrix::MatrixType transformType{VMatrix::MatrixType::None};
@@ -268,4 +404,53 @@ static inline uint32_t interpolate_pixel(uint32_t x, uint32_t a, uint32_t y,
     return x;
 }
 
+// distx and disty are the weights of the right and bottom pixels, 0 - 256.
+static inline uint32_t interpolate_4_pixels(uint32_t tl, uint32_t tr,
+                                            uint32_t bl, uint32_t br,
+                                            uint32_t distx, uint32_t disty)
+{
+    uint32_t idistx = 256 - distx;
+    uint32_t idisty = 256 - disty;
+    uint32_t xtop = interpolate_pixel(tl, idistx, tr, distx);
+    uint32_t xbot = interpolate_pixel(bl, idistx, br, distx);
+    return interpolate_pixel(xtop, idisty, xbot, disty);
+}
+
+// samples the texture at a 16.16 fixed point position, clamped to its clip.
+static inline uint32_t textureBilinearPixel(const VTextureData *tex, int fx,
+                                            int fy)
+{
+    int x1 = fx >> 16;
+    int y1 = fy >> 16;
+    int x2 = x1 + 1;
+    int y2 = y1 + 1;
+
+    x1 = x1 < tex->left ? tex->left : (x1 > tex->right ? tex->right : x1);
+    x2 = x2 < tex->left ? tex->left : (x2 > tex->right ? tex->right : x2);
+    y1 = y1 < tex->top ? tex->top : (y1 > tex->bottom ? tex->bottom : y1);
+    y2 = y2 < tex->top ? tex->top : (y2 > tex->bottom ? tex->bottom : y2);
+
+    uint32_t distx = uint32_t((fx & 0xffff) + 0x80) >> 8;
+    uint32_t disty = uint32_t((fy & 0xffff) + 0x80) >> 8;
+
+    return interpolate_4_pixels(tex->pixel(x1, y1), tex->pixel(x2, y1),
+                                tex->pixel(x1, y2), tex->pixel(x2, y2), distx,
+                                disty);
+}
+
+// luminosity of the unpremultiplied color, transparent pixels are kept.
+static inline uint32_t lumaPixel(uint32_t p)
+{
+    int alpha = vAlpha(p);
+    if (alpha == 0) return p;
+
+    uint32_t inv = unpremultiplyTable[alpha];
+    int      red = int((uint32_t(vRed(p)) * inv) >> 16);
+    int      green = int((uint32_t(vGreen(p)) * inv) >> 16);
+    int      blue = int((uint32_t(vBlue(p)) * inv) >> 16);
+
+    int luminosity = int(0.299f * red + 0.587f * green + 0.114f * blue);
+    return uint32_t(luminosity) << 24;
+}
+
 #endif  // QDRAWHELPER_P_H
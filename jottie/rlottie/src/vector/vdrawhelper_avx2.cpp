@@ -0,0 +1,547 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "vcpu.h"
+
+#ifdef V_CPU_DISPATCH_X86
+
+#include <immintrin.h>
+#include <cstring>
+
+#include "vdrawhelper.h"
+
+/*
+ * The kernels match the scalar ones in vdrawhelper_common.cpp bit for bit,
+ * a channel product is truncated the same way BYTE_MUL does it.
+ */
+
+// Each 32bits components of alphaChannel must be in the form 0x00AA00AA
+V_TARGET_AVX2 static inline __m256i v8_byte_mul_avx2(__m256i c, __m256i a)
+{
+    const __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+
+    __m256i v_ag = _mm256_srli_epi16(c, 8);
+    __m256i v_rb = _mm256_and_si256(c, rb_mask);
+
+    v_ag = _mm256_mullo_epi16(v_ag, a);
+    v_rb = _mm256_mullo_epi16(v_rb, a);
+
+    v_ag = _mm256_andnot_si256(rb_mask, v_ag);
+    v_rb = _mm256_srli_epi16(v_rb, 8);
+
+    return _mm256_or_si256(v_ag, v_rb);
+}
+
+// dest = x * a + y * b, a and b in the form 0x00AA00AA, a + b <= 256
+V_TARGET_AVX2 static inline __m256i v8_interpolate_avx2(__m256i x, __m256i a,
+                                                        __m256i y, __m256i b)
+{
+    const __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+
+    __m256i v_ag = _mm256_add_epi16(
+        _mm256_mullo_epi16(_mm256_srli_epi16(x, 8), a),
+        _mm256_mullo_epi16(_mm256_srli_epi16(y, 8), b));
+    __m256i v_rb = _mm256_add_epi16(
+        _mm256_mullo_epi16(_mm256_and_si256(x, rb_mask), a),
+        _mm256_mullo_epi16(_mm256_and_si256(y, rb_mask), b));
+
+    v_ag = _mm256_andnot_si256(rb_mask, v_ag);
+    v_rb = _mm256_srli_epi16(v_rb, 8);
+
+    return _mm256_or_si256(v_ag, v_rb);
+}
+
+// spreads the low byte of each 32bits component to 0x00AA00AA
+V_TARGET_AVX2 static inline __m256i v8_spread_alpha_avx2(__m256i a)
+{
+    return _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+}
+
+V_TARGET_AVX2 static inline __m256i v8_alpha_avx2(__m256i c)
+{
+    return v8_spread_alpha_avx2(_mm256_srli_epi32(c, 24));
+}
+
+V_TARGET_AVX2 static inline __m256i v8_inv_alpha_avx2(__m256i c)
+{
+    return v8_spread_alpha_avx2(
+        _mm256_srli_epi32(_mm256_xor_si256(c, _mm256_set1_epi32(-1)), 24));
+}
+
+// a * const_alpha + cia for the low byte of each 32bits component
+V_TARGET_AVX2 static inline __m256i v8_const_alpha_avx2(__m256i a,
+                                                        __m256i v_alpha,
+                                                        __m256i v_cia)
+{
+    a = _mm256_srli_epi32(_mm256_mullo_epi16(a, v_alpha), 8);
+    return v8_spread_alpha_avx2(_mm256_add_epi32(a, v_cia));
+}
+
+#define V8_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define V8_STORE(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+
+// dest = color + (dest * alpha)
+V_TARGET_AVX2 static void copy_helper_avx2(uint32_t *dest, int length,
+                                           uint32_t color, uint32_t alpha)
+{
+    const __m256i v_color = _mm256_set1_epi32(int(color));
+    const __m256i v_a = _mm256_set1_epi16(short(alpha));
+
+    for (; length >= 8; length -= 8, dest += 8) {
+        __m256i v_dest = v8_byte_mul_avx2(V8_LOAD(dest), v_a);
+        V8_STORE(dest, _mm256_add_epi32(v_dest, v_color));
+    }
+    for (int i = 0; i < length; ++i)
+        dest[i] = color + BYTE_MUL(dest[i], alpha);
+}
+
+// dest = dest * alpha
+V_TARGET_AVX2 static void scale_helper_avx2(uint32_t *dest, int length,
+                                            uint32_t alpha)
+{
+    const __m256i v_a = _mm256_set1_epi16(short(alpha));
+
+    for (; length >= 8; length -= 8, dest += 8)
+        V8_STORE(dest, v8_byte_mul_avx2(V8_LOAD(dest), v_a));
+    for (int i = 0; i < length; ++i) dest[i] = BYTE_MUL(dest[i], alpha);
+}
+
+V_TARGET_AVX2 static void color_Source_avx2(uint32_t *dest, int length,
+                                            uint32_t color,
+                                            uint32_t const_alpha)
+{
+    if (const_alpha == 255) {
+        const __m256i v_color = _mm256_set1_epi32(int(color));
+        for (; length >= 8; length -= 8, dest += 8) V8_STORE(dest, v_color);
+        for (int i = 0; i < length; ++i) dest[i] = color;
+    } else {
+        color = BYTE_MUL(color, const_alpha);
+        copy_helper_avx2(dest, length, color, 255 - const_alpha);
+    }
+}
+
+V_TARGET_AVX2 static void color_SourceOver_avx2(uint32_t *dest, int length,
+                                                uint32_t color,
+                                                uint32_t const_alpha)
+{
+    if (const_alpha != 255) color = BYTE_MUL(color, const_alpha);
+    copy_helper_avx2(dest, length, color, 255 - vAlpha(color));
+}
+
+V_TARGET_AVX2 static void color_DestinationIn_avx2(uint32_t *dest, int length,
+                                                   uint32_t color,
+                                                   uint32_t const_alpha)
+{
+    uint32_t a = vAlpha(color);
+    if (const_alpha != 255) a = BYTE_MUL(a, const_alpha) + 255 - const_alpha;
+    scale_helper_avx2(dest, length, a);
+}
+
+V_TARGET_AVX2 static void color_DestinationOut_avx2(uint32_t *dest,
+                                                    int length, uint32_t color,
+                                                    uint32_t const_alpha)
+{
+    uint32_t a = vAlpha(~color);
+    if (const_alpha != 255) a = BYTE_MUL(a, const_alpha) + 255 - const_alpha;
+    scale_helper_avx2(dest, length, a);
+}
+
+V_TARGET_AVX2 static void src_Source_avx2(uint32_t *dest, int length,
+                                          const uint32_t *src,
+                                          uint32_t const_alpha)
+{
+    if (const_alpha == 255) {
+        memcpy(dest, src, size_t(length) * sizeof(uint32_t));
+        return;
+    }
+
+    uint32_t      ialpha = 255 - const_alpha;
+    const __m256i v_alpha = _mm256_set1_epi16(short(const_alpha));
+    const __m256i v_ialpha = _mm256_set1_epi16(short(ialpha));
+
+    for (; length >= 8; length -= 8, dest += 8, src += 8) {
+        V8_STORE(dest, v8_interpolate_avx2(V8_LOAD(src), v_alpha,
+                                           V8_LOAD(dest), v_ialpha));
+    }
+    for (int i = 0; i < length; ++i)
+        dest[i] = interpolate_pixel(src[i], const_alpha, dest[i], ialpha);
+}
+
+V_TARGET_AVX2 static void src_SourceOver_avx2(uint32_t *dest, int length,
+                                              const uint32_t *src,
+                                              uint32_t const_alpha)
+{
+    uint32_t s, sia;
+
+    if (const_alpha == 255) {
+        const __m256i v_amask = _mm256_set1_epi32(int(0xff000000));
+        const __m256i v_zero = _mm256_setzero_si256();
+
+        for (; length >= 8; length -= 8, dest += 8, src += 8) {
+            __m256i v_src = V8_LOAD(src);
+
+            // opaque and fully transparent runs are common in layers.
+            __m256i v_opaque =
+                _mm256_cmpeq_epi32(_mm256_and_si256(v_src, v_amask), v_amask);
+            if (_mm256_movemask_epi8(v_opaque) == -1) {
+                V8_STORE(dest, v_src);
+                continue;
+            }
+            __m256i v_empty = _mm256_cmpeq_epi32(v_src, v_zero);
+            if (_mm256_movemask_epi8(v_empty) == -1) continue;
+
+            __m256i v_dest = V8_LOAD(dest);
+            __m256i v_res = _mm256_add_epi32(
+                v_src, v8_byte_mul_avx2(v_dest, v8_inv_alpha_avx2(v_src)));
+            V8_STORE(dest, _mm256_blendv_epi8(v_res, v_dest, v_empty));
+        }
+        for (int i = 0; i < length; ++i) {
+            s = src[i];
+            if (s >= 0xff000000)
+                dest[i] = s;
+            else if (s != 0) {
+                sia = vAlpha(~s);
+                dest[i] = s + BYTE_MUL(dest[i], sia);
+            }
+        }
+    } else {
+        const __m256i v_alpha = _mm256_set1_epi16(short(const_alpha));
+
+        for (; length >= 8; length -= 8, dest += 8, src += 8) {
+            __m256i v_src = v8_byte_mul_avx2(V8_LOAD(src), v_alpha);
+            __m256i v_dest =
+                v8_byte_mul_avx2(V8_LOAD(dest), v8_inv_alpha_avx2(v_src));
+            V8_STORE(dest, _mm256_add_epi32(v_src, v_dest));
+        }
+        for (int i = 0; i < length; ++i) {
+            s = BYTE_MUL(src[i], const_alpha);
+            sia = vAlpha(~s);
+            dest[i] = s + BYTE_MUL(dest[i], sia);
+        }
+    }
+}
+
+V_TARGET_AVX2 static void src_DestinationIn_avx2(uint32_t *dest, int length,
+                                                 const uint32_t *src,
+                                                 uint32_t const_alpha)
+{
+    if (const_alpha == 255) {
+        for (; length >= 8; length -= 8, dest += 8, src += 8) {
+            V8_STORE(dest, v8_byte_mul_avx2(V8_LOAD(dest),
+                                            v8_alpha_avx2(V8_LOAD(src))));
+        }
+        for (int i = 0; i < length; ++i)
+            dest[i] = BYTE_MUL(dest[i], vAlpha(src[i]));
+    } else {
+        uint32_t      cia = 255 - const_alpha;
+        const __m256i v_alpha = _mm256_set1_epi32(int(const_alpha));
+        const __m256i v_cia = _mm256_set1_epi32(int(cia));
+
+        for (; length >= 8; length -= 8, dest += 8, src += 8) {
+            __m256i v_a = v8_const_alpha_avx2(
+                _mm256_srli_epi32(V8_LOAD(src), 24), v_alpha, v_cia);
+            V8_STORE(dest, v8_byte_mul_avx2(V8_LOAD(dest), v_a));
+        }
+        for (int i = 0; i < length; ++i) {
+            uint32_t a = BYTE_MUL(vAlpha(src[i]), const_alpha) + cia;
+            dest[i] = BYTE_MUL(dest[i], a);
+        }
+    }
+}
+
+V_TARGET_AVX2 static void src_DestinationOut_avx2(uint32_t *dest, int length,
+                                                  const uint32_t *src,
+                                                  uint32_t const_alpha)
+{
+    if (const_alpha == 255) {
+        for (; length >= 8; length -= 8, dest += 8, src += 8) {
+            V8_STORE(dest, v8_byte_mul_avx2(V8_LOAD(dest),
+                                            v8_inv_alpha_avx2(V8_LOAD(src))));
+        }
+        for (int i = 0; i < length; ++i)
+            dest[i] = BYTE_MUL(dest[i], vAlpha(~src[i]));
+    } else {
+        uint32_t      cia = 255 - const_alpha;
+        const __m256i v_alpha = _mm256_set1_epi32(int(const_alpha));
+        const __m256i v_cia = _mm256_set1_epi32(int(cia));
+        const __m256i v_ones = _mm256_set1_epi32(-1);
+
+        for (; length >= 8; length -= 8, dest += 8, src += 8) {
+            __m256i v_sia = _mm256_srli_epi32(
+                _mm256_xor_si256(V8_LOAD(src), v_ones), 24);
+            __m256i v_a = v8_const_alpha_avx2(v_sia, v_alpha, v_cia);
+            V8_STORE(dest, v8_byte_mul_avx2(V8_LOAD(dest), v_a));
+        }
+        for (int i = 0; i < length; ++i) {
+            uint32_t sia = BYTE_MUL(vAlpha(~src[i]), const_alpha) + cia;
+            dest[i] = BYTE_MUL(dest[i], sia);
+        }
+    }
+}
+
+// colour table index of each position, see gradientClamp().
+V_TARGET_AVX2 static inline __m256i v8_gradient_clamp_avx2(
+    const VGradientData *grad, __m256i ipos)
+{
+    const int size = VGradient::colorTableSize;
+
+    if (grad->mSpread == VGradient::Spread::Repeat) {
+        return _mm256_and_si256(ipos, _mm256_set1_epi32(size - 1));
+    } else if (grad->mSpread == VGradient::Spread::Reflect) {
+        // the second half of a period runs backwards.
+        const __m256i limit = _mm256_set1_epi32(2 * size - 1);
+        ipos = _mm256_and_si256(ipos, limit);
+        __m256i back = _mm256_cmpgt_epi32(ipos, _mm256_set1_epi32(size - 1));
+        return _mm256_xor_si256(ipos, _mm256_and_si256(back, limit));
+    } else {
+        return _mm256_min_epi32(_mm256_max_epi32(ipos, _mm256_setzero_si256()),
+                                _mm256_set1_epi32(size - 1));
+    }
+}
+
+V_TARGET_AVX2 static inline __m256i v8_gradient_fetch_avx2(
+    const VGradientData *grad, __m256i ipos)
+{
+    return _mm256_i32gather_epi32((const int *)grad->mColorTable,
+                                  v8_gradient_clamp_avx2(grad, ipos), 4);
+}
+
+V_TARGET_AVX2 static void gradient_Linear_avx2(uint32_t *buffer, int length,
+                                               const VGradientData *grad,
+                                               int t, int inc)
+{
+    __m256i v_t = _mm256_add_epi32(
+        _mm256_set1_epi32(t + FIXPT_SIZE / 2),
+        _mm256_mullo_epi32(_mm256_set1_epi32(inc),
+                           _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    const __m256i v_inc = _mm256_set1_epi32(8 * inc);
+
+    for (; length >= 8; length -= 8, buffer += 8, t += 8 * inc) {
+        V8_STORE(buffer, v8_gradient_fetch_avx2(
+                             grad, _mm256_srai_epi32(v_t, FIXPT_BITS)));
+        v_t = _mm256_add_epi32(v_t, v_inc);
+    }
+    for (int i = 0; i < length; ++i, t += inc)
+        buffer[i] = gradientPixelFixed(grad, t);
+}
+
+/*
+ * Every lane evaluates the position of its own column, the tail of a span
+ * goes through the same vector code into a scratch buffer so a pixel gets
+ * the same colour wherever its span starts.
+ */
+V_TARGET_AVX2 static void gradient_Radial_avx2(
+    uint32_t *buffer, int x, int length, const Operator *op,
+    const VGradientData *grad, float det, float delta_det,
+    float delta_delta_det, float b, float delta_b)
+{
+    const __m256 v_det = _mm256_set1_ps(det);
+    const __m256 v_delta = _mm256_set1_ps(delta_det);
+    const __m256 v_delta_delta = _mm256_set1_ps(delta_delta_det);
+    const __m256 v_b = _mm256_set1_ps(b);
+    const __m256 v_delta_b = _mm256_set1_ps(delta_b);
+    const __m256 v_zero = _mm256_setzero_ps();
+    const __m256 v_scale = _mm256_set1_ps(VGradient::colorTableSize - 1);
+    const __m256 v_half = _mm256_set1_ps(0.5f);
+    const __m256 v_limit = _mm256_set1_ps(float(1 << 30));
+    const __m256 v_fradius = _mm256_set1_ps(grad->radial.fradius);
+    const __m256 v_dr = _mm256_set1_ps(op->radial.dr);
+
+    __m256i v_column = _mm256_add_epi32(
+        _mm256_set1_epi32(x), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i v_eight = _mm256_set1_epi32(8);
+
+    for (; length > 0; length -= 8, buffer += 8) {
+        __m256 v_n = _mm256_cvtepi32_ps(v_column);
+        __m256 v_d = _mm256_mul_ps(v_n, v_delta_delta);
+        v_d = _mm256_add_ps(v_det,
+                            _mm256_mul_ps(v_n, _mm256_add_ps(v_delta, v_d)));
+        __m256 v_w = _mm256_sub_ps(
+            _mm256_sqrt_ps(v_d),
+            _mm256_add_ps(v_b, _mm256_mul_ps(v_n, v_delta_b)));
+        __m256 v_pos = _mm256_add_ps(_mm256_mul_ps(v_w, v_scale), v_half);
+        // a NaN from a negative det ends up at the lower limit.
+        v_pos = _mm256_min_ps(
+            _mm256_max_ps(v_pos, _mm256_sub_ps(v_zero, v_limit)), v_limit);
+        __m256i v_px = v8_gradient_fetch_avx2(grad, _mm256_cvttps_epi32(v_pos));
+
+        if (op->radial.extended) {
+            __m256 v_valid = _mm256_and_ps(
+                _mm256_cmp_ps(v_d, v_zero, _CMP_GE_OQ),
+                _mm256_cmp_ps(
+                    _mm256_add_ps(v_fradius, _mm256_mul_ps(v_dr, v_w)), v_zero,
+                    _CMP_GE_OQ));
+            v_px = _mm256_and_si256(v_px, _mm256_castps_si256(v_valid));
+        }
+
+        if (length >= 8) {
+            V8_STORE(buffer, v_px);
+        } else {
+            alignas(32) uint32_t pixels[8];
+            V8_STORE(pixels, v_px);
+            memcpy(buffer, pixels, size_t(length) * sizeof(uint32_t));
+        }
+
+        v_column = _mm256_add_epi32(v_column, v_eight);
+    }
+}
+
+V_TARGET_AVX2 static inline __m256i v8_clamp_avx2(__m256i v, __m256i lo,
+                                                  __m256i hi)
+{
+    return _mm256_min_epi32(_mm256_max_epi32(v, lo), hi);
+}
+
+// right and bottom weights of 16.16 positions, 0 - 256 spread to 0x00AA00AA
+V_TARGET_AVX2 static inline __m256i v8_texture_weight_avx2(__m256i f)
+{
+    __m256i w = _mm256_and_si256(f, _mm256_set1_epi32(0xffff));
+    w = _mm256_srli_epi32(_mm256_add_epi32(w, _mm256_set1_epi32(0x80)), 8);
+    return v8_spread_alpha_avx2(w);
+}
+
+V_TARGET_AVX2 static void texture_Bilinear_avx2(uint32_t *buffer, int length,
+                                                const VTextureData *tex,
+                                                int fx, int fy, int fdx,
+                                                int fdy)
+{
+    const int *   pixels = (const int *)tex->pixelRef(0, 0);
+    const __m256i v_stride = _mm256_set1_epi32(int(tex->bytesPerLine() / 4));
+    const __m256i v_left = _mm256_set1_epi32(tex->left);
+    const __m256i v_right = _mm256_set1_epi32(tex->right);
+    const __m256i v_top = _mm256_set1_epi32(tex->top);
+    const __m256i v_bottom = _mm256_set1_epi32(tex->bottom);
+    const __m256i v_one = _mm256_set1_epi32(1);
+    const __m256i v_full = _mm256_set1_epi16(256);
+    const __m256i v_fdx = _mm256_set1_epi32(8 * fdx);
+    const __m256i v_fdy = _mm256_set1_epi32(8 * fdy);
+    const __m256i v_lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    __m256i v_fx = _mm256_add_epi32(
+        _mm256_set1_epi32(fx),
+        _mm256_mullo_epi32(_mm256_set1_epi32(fdx), v_lane));
+    __m256i v_fy = _mm256_add_epi32(
+        _mm256_set1_epi32(fy),
+        _mm256_mullo_epi32(_mm256_set1_epi32(fdy), v_lane));
+
+    for (; length >= 8; length -= 8, buffer += 8, fx += 8 * fdx,
+                        fy += 8 * fdy) {
+        __m256i x1 = _mm256_srai_epi32(v_fx, 16);
+        __m256i y1 = _mm256_srai_epi32(v_fy, 16);
+        __m256i x2 =
+            v8_clamp_avx2(_mm256_add_epi32(x1, v_one), v_left, v_right);
+        __m256i y2 =
+            v8_clamp_avx2(_mm256_add_epi32(y1, v_one), v_top, v_bottom);
+        x1 = v8_clamp_avx2(x1, v_left, v_right);
+        y1 = v8_clamp_avx2(y1, v_top, v_bottom);
+
+        __m256i row1 = _mm256_mullo_epi32(y1, v_stride);
+        __m256i row2 = _mm256_mullo_epi32(y2, v_stride);
+
+        __m256i tl =
+            _mm256_i32gather_epi32(pixels, _mm256_add_epi32(row1, x1), 4);
+        __m256i tr =
+            _mm256_i32gather_epi32(pixels, _mm256_add_epi32(row1, x2), 4);
+        __m256i bl =
+            _mm256_i32gather_epi32(pixels, _mm256_add_epi32(row2, x1), 4);
+        __m256i br =
+            _mm256_i32gather_epi32(pixels, _mm256_add_epi32(row2, x2), 4);
+
+        __m256i distx = v8_texture_weight_avx2(v_fx);
+        __m256i disty = v8_texture_weight_avx2(v_fy);
+        __m256i idistx = _mm256_sub_epi16(v_full, distx);
+        __m256i idisty = _mm256_sub_epi16(v_full, disty);
+
+        __m256i top = v8_interpolate_avx2(tl, idistx, tr, distx);
+        __m256i bottom = v8_interpolate_avx2(bl, idistx, br, distx);
+        V8_STORE(buffer, v8_interpolate_avx2(top, idisty, bottom, disty));
+
+        v_fx = _mm256_add_epi32(v_fx, v_fdx);
+        v_fy = _mm256_add_epi32(v_fy, v_fdy);
+    }
+    for (int i = 0; i < length; ++i, fx += fdx, fy += fdy)
+        buffer[i] = textureBilinearPixel(tex, fx, fy);
+}
+
+V_TARGET_AVX2 static void matte_Luma_avx2(uint32_t *buffer, int length)
+{
+    const __m256i v_mask = _mm256_set1_epi32(0xff);
+    const __m256i v_zero = _mm256_setzero_si256();
+    const __m256  v_red = _mm256_set1_ps(0.299f);
+    const __m256  v_green = _mm256_set1_ps(0.587f);
+    const __m256  v_blue = _mm256_set1_ps(0.114f);
+    const int *   table =
+        reinterpret_cast<const int *>(unpremultiplyTable.data());
+
+    for (; length >= 8; length -= 8, buffer += 8) {
+        __m256i p = V8_LOAD(buffer);
+        __m256i a = _mm256_srli_epi32(p, 24);
+        __m256i clear = _mm256_cmpeq_epi32(a, v_zero);
+        if (_mm256_movemask_epi8(clear) == -1) continue;
+
+        __m256i inv = _mm256_i32gather_epi32(table, a, 4);
+        __m256i r = _mm256_srli_epi32(
+            _mm256_mullo_epi32(
+                _mm256_and_si256(_mm256_srli_epi32(p, 16), v_mask), inv),
+            16);
+        __m256i g = _mm256_srli_epi32(
+            _mm256_mullo_epi32(
+                _mm256_and_si256(_mm256_srli_epi32(p, 8), v_mask), inv),
+            16);
+        __m256i b = _mm256_srli_epi32(
+            _mm256_mullo_epi32(_mm256_and_si256(p, v_mask), inv), 16);
+
+        // same evaluation order as lumaPixel().
+        __m256 luma = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(v_red, _mm256_cvtepi32_ps(r)),
+                          _mm256_mul_ps(v_green, _mm256_cvtepi32_ps(g))),
+            _mm256_mul_ps(v_blue, _mm256_cvtepi32_ps(b)));
+        __m256i v_luma = _mm256_slli_epi32(_mm256_cvttps_epi32(luma), 24);
+
+        V8_STORE(buffer, _mm256_blendv_epi8(v_luma, p, clear));
+    }
+    for (int i = 0; i < length; ++i) buffer[i] = lumaPixel(buffer[i]);
+}
+
+#undef V8_LOAD
+#undef V8_STORE
+
+void RenderFuncTable::avx2()
+{
+    if (!vCpuFeatures().avx2) return;
+
+    updateColor(BlendMode::Src, color_Source_avx2);
+    updateColor(BlendMode::SrcOver, color_SourceOver_avx2);
+    updateColor(BlendMode::DestIn, color_DestinationIn_avx2);
+    updateColor(BlendMode::DestOut, color_DestinationOut_avx2);
+
+    updateSrc(BlendMode::Src, src_Source_avx2);
+    updateSrc(BlendMode::SrcOver, src_SourceOver_avx2);
+    updateSrc(BlendMode::DestIn, src_DestinationIn_avx2);
+    updateSrc(BlendMode::DestOut, src_DestinationOut_avx2);
+
+    updateGradient(gradient_Linear_avx2, gradient_Radial_avx2);
+    updateTexture(texture_Bilinear_avx2);
+    updateMatte(matte_Luma_avx2);
+}
+
+#endif
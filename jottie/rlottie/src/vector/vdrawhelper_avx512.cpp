@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "vcpu.h"
+
+#ifdef V_CPU_DISPATCH_X86
+
+#include <immintrin.h>
+#include <cstring>
+
+#include "vdrawhelper.h"
+
+/*
+ * Same kernels as vdrawhelper_avx2.cpp on 16 pixels at a time, the tail of
+ * a span goes through masked loads and stores instead of a scalar loop.
+ */
+
+// Each 32bits components of alphaChannel must be in the form 0x00AA00AA
+V_TARGET_AVX512 static inline __m512i v16_byte_mul_avx512(__m512i c,
+                                                          __m512i a)
+{
+    const __m512i rb_mask = _mm512_set1_epi32(0x00FF00FF);
+
+    __m512i v_ag = _mm512_srli_epi16(c, 8);
+    __m512i v_rb = _mm512_and_si512(c, rb_mask);
+
+    v_ag = _mm512_mullo_epi16(v_ag, a);
+    v_rb = _mm512_mullo_epi16(v_rb, a);
+
+    v_ag = _mm512_andnot_si512(rb_mask, v_ag);
+    v_rb = _mm512_srli_epi16(v_rb, 8);
+
+    return _mm512_or_si512(v_ag, v_rb);
+}
+
+// dest = x * a + y * b, a and b in the form 0x00AA00AA
+V_TARGET_AVX512 static inline __m512i v16_interpolate_avx512(__m512i x,
+                                                             __m512i a,
+                                                             __m512i y,
+                                                             __m512i b)
+{
+    const __m512i rb_mask = _mm512_set1_epi32(0x00FF00FF);
+
+    __m512i v_ag = _mm512_add_epi16(
+        _mm512_mullo_epi16(_mm512_srli_epi16(x, 8), a),
+        _mm512_mullo_epi16(_mm512_srli_epi16(y, 8), b));
+    __m512i v_rb = _mm512_add_epi16(
+        _mm512_mullo_epi16(_mm512_and_si512(x, rb_mask), a),
+        _mm512_mullo_epi16(_mm512_and_si512(y, rb_mask), b));
+
+    v_ag = _mm512_andnot_si512(rb_mask, v_ag);
+    v_rb = _mm512_srli_epi16(v_rb, 8);
+
+    return _mm512_or_si512(v_ag, v_rb);
+}
+
+// spreads the low byte of each 32bits component to 0x00AA00AA
+V_TARGET_AVX512 static inline __m512i v16_spread_alpha_avx512(__m512i a)
+{
+    return _mm512_or_si512(a, _mm512_slli_epi32(a, 16));
+}
+
+V_TARGET_AVX512 static inline __m512i v16_alpha_avx512(__m512i c)
+{
+    return v16_spread_alpha_avx512(_mm512_srli_epi32(c, 24));
+}
+
+V_TARGET_AVX512 static inline __m512i v16_inv_alpha_avx512(__m512i c)
+{
+    return v16_spread_alpha_avx512(
+        _mm512_srli_epi32(_mm512_xor_si512(c, _mm512_set1_epi32(-1)), 24));
+}
+
+// a * const_alpha + cia for the low byte of each 32bits component
+V_TARGET_AVX512 static inline __m512i v16_const_alpha_avx512(__m512i a,
+                                                             __m512i v_alpha,
+                                                             __m512i v_cia)
+{
+    a = _mm512_srli_epi32(_mm512_mullo_epi16(a, v_alpha), 8);
+    return v16_spread_alpha_avx512(_mm512_add_epi32(a, v_cia));
+}
+
+// mask of the pixels left in a span, all of them for a full vector.
+V_TARGET_AVX512 static inline __mmask16 v16_mask(int length)
+{
+    return length >= 16 ? __mmask16(0xFFFF)
+                        : __mmask16((1u << unsigned(length)) - 1);
+}
+
+#define V16_LOAD(p, m) _mm512_maskz_loadu_epi32(m, p)
+#define V16_STORE(p, m, v) _mm512_mask_storeu_epi32(p, m, v)
+
+// dest = color + (dest * alpha)
+V_TARGET_AVX512 static void copy_helper_avx512(uint32_t *dest, int length,
+                                               uint32_t color, uint32_t alpha)
+{
+    const __m512i v_color = _mm512_set1_epi32(int(color));
+    const __m512i v_a = _mm512_set1_epi16(short(alpha));
+
+    for (; length > 0; length -= 16, dest += 16) {
+        __mmask16 m = v16_mask(length);
+        __m512i   v_dest = v16_byte_mul_avx512(V16_LOAD(dest, m), v_a);
+        V16_STORE(dest, m, _mm512_add_epi32(v_dest, v_color));
+    }
+}
+
+// dest = dest * alpha
+V_TARGET_AVX512 static void scale_helper_avx512(uint32_t *dest, int length,
+                                                uint32_t alpha)
+{
+    const __m512i v_a = _mm512_set1_epi16(short(alpha));
+
+    for (; length > 0; length -= 16, dest += 16) {
+        __mmask16 m = v16_mask(length);
+        V16_STORE(dest, m, v16_byte_mul_avx512(V16_LOAD(dest, m), v_a));
+    }
+}
+
+V_TARGET_AVX512 static void color_Source_avx512(uint32_t *dest, int length,
+                                                uint32_t color,
+                                                uint32_t const_alpha)
+{
+    if (const_alpha == 255) {
+        const __m512i v_color = _mm512_set1_epi32(int(color));
+        for (; length > 0; length -= 16, dest += 16)
+            V16_STORE(dest, v16_mask(length), v_color);
+    } else {
+        color = BYTE_MUL(color, const_alpha);
+        copy_helper_avx512(dest, length, color, 255 - const_alpha);
+    }
+}
+
+V_TARGET_AVX512 static void color_SourceOver_avx512(uint32_t *dest,
+                                                    int length, uint32_t color,
+                                                    uint32_t const_alpha)
+{
+    if (const_alpha != 255) color = BYTE_MUL(color, const_alpha);
+    copy_helper_avx512(dest, length, color, 255 - vAlpha(color));
+}
+
+V_TARGET_AVX512 static void color_DestinationIn_avx512(uint32_t *dest,
+                                                       int length,
+                                                       uint32_t color,
+                                                       uint32_t const_alpha)
+{
+    uint32_t a = vAlpha(color);
+    if (const_alpha != 255) a = BYTE_MUL(a, const_alpha) + 255 - const_alpha;
+    scale_helper_avx512(dest, length, a);
+}
+
+V_TARGET_AVX512 static void color_DestinationOut_avx512(uint32_t *dest,
+                                                        int length,
+                                                        uint32_t color,
+                                                        uint32_t const_alpha)
+{
+    uint32_t a = vAlpha(~color);
+    if (const_alpha != 255) a = BYTE_MUL(a, const_alpha) + 255 - const_alpha;
+    scale_helper_avx512(dest, length, a);
+}
+
+V_TARGET_AVX512 static void src_Source_avx512(uint32_t *dest, int length,
+                                              const uint32_t *src,
+                                              uint32_t const_alpha)
+{
+    if (const_alpha == 255) {
+        memcpy(dest, src, size_t(length) * sizeof(uint32_t));
+        return;
+    }
+
+    const __m512i v_alpha = _mm512_set1_epi16(short(const_alpha));
+    const __m512i v_ialpha = _mm512_set1_epi16(short(255 - const_alpha));
+
+    for (; length > 0; length -= 16, dest += 16, src += 16) {
+        __mmask16 m = v16_mask(length);
+        V16_STORE(dest, m,
+                  v16_interpolate_avx512(V16_LOAD(src, m), v_alpha,
+                                         V16_LOAD(dest, m), v_ialpha));
+    }
+}
+
+V_TARGET_AVX512 static void src_SourceOver_avx512(uint32_t *dest, int length,
+                                                  const uint32_t *src,
+                                                  uint32_t const_alpha)
+{
+    if (const_alpha == 255) {
+        const __m512i v_amask = _mm512_set1_epi32(int(0xff000000));
+
+        for (; length > 0; length -= 16, dest += 16, src += 16) {
+            __mmask16 m = v16_mask(length);
+            __m512i   v_src = V16_LOAD(src, m);
+
+            // opaque pixels are copied, fully transparent ones skipped.
+            __mmask16 opaque = _mm512_mask_cmpeq_epi32_mask(
+                m, _mm512_and_si512(v_src, v_amask), v_amask);
+            __mmask16 blend =
+                _mm512_mask_test_epi32_mask(m & ~opaque, v_src, v_src);
+
+            V16_STORE(dest, opaque, v_src);
+            if (!blend) continue;
+
+            __m512i v_dest = V16_LOAD(dest, blend);
+            V16_STORE(dest, blend,
+                      _mm512_add_epi32(v_src,
+                                       v16_byte_mul_avx512(
+                                           v_dest, v16_inv_alpha_avx512(v_src))));
+        }
+    } else {
+        const __m512i v_alpha = _mm512_set1_epi16(short(const_alpha));
+
+        for (; length > 0; length -= 16, dest += 16, src += 16) {
+            __mmask16 m = v16_mask(length);
+            __m512i   v_src = v16_byte_mul_avx512(V16_LOAD(src, m), v_alpha);
+            __m512i   v_dest = v16_byte_mul_avx512(V16_LOAD(dest, m),
+                                                 v16_inv_alpha_avx512(v_src));
+            V16_STORE(dest, m, _mm512_add_epi32(v_src, v_dest));
+        }
+    }
+}
+
+V_TARGET_AVX512 static void src_DestinationIn_avx512(uint32_t *dest,
+                                                     int length,
+                                                     const uint32_t *src,
+                                                     uint32_t const_alpha)
+{
+    const __m512i v_alpha = _mm512_set1_epi32(int(const_alpha));
+    const __m512i v_cia = _mm512_set1_epi32(int(255 - const_alpha));
+
+    for (; length > 0; length -= 16, dest += 16, src += 16) {
+        __mmask16 m = v16_mask(length);
+        __m512i   v_src = V16_LOAD(src, m);
+        __m512i   v_a = const_alpha == 255
+                          ? v16_alpha_avx512(v_src)
+                          : v16_const_alpha_avx512(
+                                _mm512_srli_epi32(v_src, 24), v_alpha, v_cia);
+        V16_STORE(dest, m, v16_byte_mul_avx512(V16_LOAD(dest, m), v_a));
+    }
+}
+
+V_TARGET_AVX512 static void src_DestinationOut_avx512(uint32_t *dest,
+                                                      int length,
+                                                      const uint32_t *src,
+                                                      uint32_t const_alpha)
+{
+    const __m512i v_alpha = _mm512_set1_epi32(int(const_alpha));
+    const __m512i v_cia = _mm512_set1_epi32(int(255 - const_alpha));
+    const __m512i v_ones = _mm512_set1_epi32(-1);
+
+    for (; length > 0; length -= 16, dest += 16, src += 16) {
+        __mmask16 m = v16_mask(length);
+        __m512i   v_src = V16_LOAD(src, m);
+        __m512i   v_a =
+            const_alpha == 255
+                ? v16_inv_alpha_avx512(v_src)
+                : v16_const_alpha_avx512(
+                      _mm512_srli_epi32(_mm512_xor_si512(v_src, v_ones), 24),
+                      v_alpha, v_cia);
+        V16_STORE(dest, m, v16_byte_mul_avx512(V16_LOAD(dest, m), v_a));
+    }
+}
+
+#undef V16_LOAD
+#undef V16_STORE
+
+void RenderFuncTable::avx512()
+{
+    if (!vCpuFeatures().avx512bw) return;
+
+    updateColor(BlendMode::Src, color_Source_avx512);
+    updateColor(BlendMode::SrcOver, color_SourceOver_avx512);
+    updateColor(BlendMode::DestIn, color_DestinationIn_avx512);
+    updateColor(BlendMode::DestOut, color_DestinationOut_avx512);
+
+    updateSrc(BlendMode::Src, src_Source_avx512);
+    updateSrc(BlendMode::SrcOver, src_SourceOver_avx512);
+    updateSrc(BlendMode::DestIn, src_DestinationIn_avx512);
+    updateSrc(BlendMode::DestOut, src_DestinationOut_avx512);
+}
+
+#endif
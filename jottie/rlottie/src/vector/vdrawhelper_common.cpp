@@ -21,6 +21,7 @@
  */
 
 #include <cstring>
+#include "vcpu.h"
 #include "vdrawhelper.h"
 
 /*
@@ -168,6 +169,53 @@ static void src_DestinationOut(uint32_t *dest, int length, const uint32_t *src,
     }
 }
 
+static void gradient_Linear(uint32_t *buffer, int length,
+                            const VGradientData *grad, int t, int inc)
+{
+    for (int i = 0; i < length; ++i) {
+        buffer[i] = gradientPixelFixed(grad, t);
+        t += inc;
+    }
+}
+
+static void gradient_Radial(uint32_t *buffer, int x, int length,
+                            const Operator *op, const VGradientData *grad,
+                            float det, float delta_det, float delta_delta_det,
+                            float b, float delta_b)
+{
+    for (int i = 0; i < length; ++i) {
+        const float n = float(x + i);
+        buffer[i] = gradientRadialPixel(
+            op, grad, det + n * (delta_det + n * delta_delta_det),
+            b + n * delta_b);
+    }
+}
+
+static void texture_Bilinear(uint32_t *buffer, int length,
+                             const VTextureData *tex, int fx, int fy, int fdx,
+                             int fdy)
+{
+    for (int i = 0; i < length; ++i) {
+        buffer[i] = textureBilinearPixel(tex, fx, fy);
+        fx += fdx;
+        fy += fdy;
+    }
+}
+
+static constexpr std::array<uint32_t, 256> makeUnpremultiplyTable()
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t a = 1; a < 256; ++a) table[a] = (255 * 65536 + a - 1) / a;
+    return table;
+}
+
+const std::array<uint32_t, 256> unpremultiplyTable = makeUnpremultiplyTable();
+
+static void matte_Luma(uint32_t *buffer, int length)
+{
+    for (int i = 0; i < length; ++i) buffer[i] = lumaPixel(buffer[i]);
+}
+
 RenderFuncTable::RenderFuncTable()
 {
     updateColor(BlendMode::Src, color_Source);
@@ -180,10 +228,19 @@ RenderFuncTable::RenderFuncTable()
     updateSrc(BlendMode::DestIn, src_DestinationIn);
     updateSrc(BlendMode::DestOut, src_DestinationOut);
 
+    updateGradient(gradient_Linear, gradient_Radial);
+    updateTexture(texture_Bilinear);
+    updateMatte(matte_Luma);
+
 #if 0 && defined(__ARM_NEON__)
     neon();
 #endif
 #if defined(__SSE2__)
     sse();
 #endif
+#ifdef V_CPU_DISPATCH_X86
+    // picked at runtime, the wider kernels replace the narrower ones.
+    avx2();
+    avx512();
+#endif
 }
@@ -255,12 +255,271 @@ static void src_Source_sse(uint32_t* dest, int length, const uint32_t* src,
     }
 }
 
+static_assert((VGradient::colorTableSize & (VGradient::colorTableSize - 1)) == 0,
+              "the gradient kernels wrap positions with a mask");
+
+// colour table index of each position, see gradientClamp().
+static inline __m128i v4_gradient_clamp_sse2(const VGradientData *grad,
+                                             __m128i              ipos)
+{
+    const int size = VGradient::colorTableSize;
+
+    if (grad->mSpread == VGradient::Spread::Repeat) {
+        return _mm_and_si128(ipos, _mm_set1_epi32(size - 1));
+    } else if (grad->mSpread == VGradient::Spread::Reflect) {
+        // the second half of a period runs backwards.
+        const __m128i limit = _mm_set1_epi32(2 * size - 1);
+        ipos = _mm_and_si128(ipos, limit);
+        __m128i back = _mm_cmpgt_epi32(ipos, _mm_set1_epi32(size - 1));
+        return _mm_xor_si128(ipos, _mm_and_si128(back, limit));
+    } else {
+        const __m128i last = _mm_set1_epi32(size - 1);
+        ipos = _mm_and_si128(ipos, _mm_cmpgt_epi32(ipos, _mm_setzero_si128()));
+        __m128i over = _mm_cmpgt_epi32(ipos, last);
+        return _mm_or_si128(_mm_andnot_si128(over, ipos),
+                            _mm_and_si128(over, last));
+    }
+}
+
+static inline void v4_gradient_fetch_sse2(uint32_t *buffer,
+                                          const VGradientData *grad,
+                                          __m128i ipos)
+{
+    alignas(16) int index[4];
+    _mm_store_si128((__m128i *)index, v4_gradient_clamp_sse2(grad, ipos));
+
+    buffer[0] = grad->mColorTable[index[0]];
+    buffer[1] = grad->mColorTable[index[1]];
+    buffer[2] = grad->mColorTable[index[2]];
+    buffer[3] = grad->mColorTable[index[3]];
+}
+
+static void gradient_Linear_sse2(uint32_t *buffer, int length,
+                                 const VGradientData *grad, int t, int inc)
+{
+    __m128i v_t = _mm_add_epi32(_mm_set1_epi32(t + FIXPT_SIZE / 2),
+                                _mm_set_epi32(3 * inc, 2 * inc, inc, 0));
+    const __m128i v_inc = _mm_set1_epi32(4 * inc);
+
+    for (; length >= 4; length -= 4, buffer += 4, t += 4 * inc) {
+        v4_gradient_fetch_sse2(buffer, grad, _mm_srai_epi32(v_t, FIXPT_BITS));
+        v_t = _mm_add_epi32(v_t, v_inc);
+    }
+    for (int i = 0; i < length; ++i, t += inc)
+        buffer[i] = gradientPixelFixed(grad, t);
+}
+
+/*
+ * Every lane evaluates the position of its own column, the tail of a span
+ * goes through the same vector code into a scratch buffer so a pixel gets
+ * the same colour wherever its span starts.
+ */
+static void gradient_Radial_sse2(uint32_t *buffer, int x, int length,
+                                 const Operator *op, const VGradientData *grad,
+                                 float det, float delta_det,
+                                 float delta_delta_det, float b, float delta_b)
+{
+    const __m128 v_det = _mm_set1_ps(det);
+    const __m128 v_delta = _mm_set1_ps(delta_det);
+    const __m128 v_delta_delta = _mm_set1_ps(delta_delta_det);
+    const __m128 v_b = _mm_set1_ps(b);
+    const __m128 v_delta_b = _mm_set1_ps(delta_b);
+    const __m128 v_zero = _mm_setzero_ps();
+    const __m128 v_scale = _mm_set1_ps(VGradient::colorTableSize - 1);
+    const __m128 v_half = _mm_set1_ps(0.5f);
+    const __m128 v_limit = _mm_set1_ps(float(1 << 30));
+    const __m128 v_fradius = _mm_set1_ps(grad->radial.fradius);
+    const __m128 v_dr = _mm_set1_ps(op->radial.dr);
+
+    __m128i v_column =
+        _mm_add_epi32(_mm_set1_epi32(x), _mm_set_epi32(3, 2, 1, 0));
+    const __m128i v_four = _mm_set1_epi32(4);
+
+    for (; length > 0; length -= 4, buffer += 4) {
+        __m128 v_n = _mm_cvtepi32_ps(v_column);
+        __m128 v_d = _mm_mul_ps(v_n, v_delta_delta);
+        v_d = _mm_add_ps(v_det, _mm_mul_ps(v_n, _mm_add_ps(v_delta, v_d)));
+        __m128 v_w = _mm_sub_ps(_mm_sqrt_ps(v_d),
+                                _mm_add_ps(v_b, _mm_mul_ps(v_n, v_delta_b)));
+        __m128 v_pos = _mm_add_ps(_mm_mul_ps(v_w, v_scale), v_half);
+        // a NaN from a negative det ends up at the lower limit.
+        v_pos = _mm_min_ps(_mm_max_ps(v_pos, _mm_sub_ps(v_zero, v_limit)),
+                           v_limit);
+
+        alignas(16) uint32_t pixels[4];
+        uint32_t *dest = length >= 4 ? buffer : pixels;
+        v4_gradient_fetch_sse2(dest, grad, _mm_cvttps_epi32(v_pos));
+
+        if (op->radial.extended) {
+            __m128 v_valid = _mm_and_ps(
+                _mm_cmpge_ps(v_d, v_zero),
+                _mm_cmpge_ps(_mm_add_ps(v_fradius, _mm_mul_ps(v_dr, v_w)),
+                             v_zero));
+            __m128i v_px = _mm_loadu_si128((__m128i *)dest);
+            _mm_storeu_si128((__m128i *)dest,
+                             _mm_and_si128(v_px, _mm_castps_si128(v_valid)));
+        }
+
+        if (length < 4)
+            memcpy(buffer, pixels, size_t(length) * sizeof(uint32_t));
+
+        v_column = _mm_add_epi32(v_column, v_four);
+    }
+}
+
+// x * a + y * b for each channel, a and b in the form 0x00AA00AA, a + b <= 256
+static inline __m128i v4_interpolate_256_sse2(__m128i x, __m128i a, __m128i y,
+                                              __m128i b)
+{
+    const __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+
+    __m128i v_ag = _mm_add_epi16(_mm_mullo_epi16(_mm_srli_epi16(x, 8), a),
+                                 _mm_mullo_epi16(_mm_srli_epi16(y, 8), b));
+    __m128i v_rb =
+        _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(x, rb_mask), a),
+                      _mm_mullo_epi16(_mm_and_si128(y, rb_mask), b));
+
+    v_ag = _mm_andnot_si128(rb_mask, v_ag);
+    v_rb = _mm_srli_epi16(v_rb, 8);
+
+    return _mm_or_si128(v_ag, v_rb);
+}
+
+static inline __m128i v4_clamp_sse2(__m128i v, __m128i lo, __m128i hi)
+{
+    __m128i under = _mm_cmplt_epi32(v, lo);
+    v = _mm_or_si128(_mm_andnot_si128(under, v), _mm_and_si128(under, lo));
+    __m128i over = _mm_cmpgt_epi32(v, hi);
+    return _mm_or_si128(_mm_andnot_si128(over, v), _mm_and_si128(over, hi));
+}
+
+static inline __m128i v4_texture_fetch_sse2(const VTextureData *tex,
+                                            __m128i x, __m128i y)
+{
+    alignas(16) int xs[4], ys[4];
+    _mm_store_si128((__m128i *)xs, x);
+    _mm_store_si128((__m128i *)ys, y);
+
+    return _mm_set_epi32(int(tex->pixel(xs[3], ys[3])),
+                         int(tex->pixel(xs[2], ys[2])),
+                         int(tex->pixel(xs[1], ys[1])),
+                         int(tex->pixel(xs[0], ys[0])));
+}
+
+// right and bottom weights of 16.16 positions, 0 - 256 spread to 0x00AA00AA
+static inline __m128i v4_texture_weight_sse2(__m128i f)
+{
+    __m128i w = _mm_and_si128(f, _mm_set1_epi32(0xffff));
+    w = _mm_srli_epi32(_mm_add_epi32(w, _mm_set1_epi32(0x80)), 8);
+    return _mm_or_si128(w, _mm_slli_epi32(w, 16));
+}
+
+static void texture_Bilinear_sse2(uint32_t *buffer, int length,
+                                  const VTextureData *tex, int fx, int fy,
+                                  int fdx, int fdy)
+{
+    const __m128i v_left = _mm_set1_epi32(tex->left);
+    const __m128i v_right = _mm_set1_epi32(tex->right);
+    const __m128i v_top = _mm_set1_epi32(tex->top);
+    const __m128i v_bottom = _mm_set1_epi32(tex->bottom);
+    const __m128i v_one = _mm_set1_epi32(1);
+    const __m128i v_full = _mm_set1_epi16(256);
+    const __m128i v_fdx = _mm_set1_epi32(4 * fdx);
+    const __m128i v_fdy = _mm_set1_epi32(4 * fdy);
+
+    __m128i v_fx = _mm_add_epi32(_mm_set1_epi32(fx),
+                                 _mm_set_epi32(3 * fdx, 2 * fdx, fdx, 0));
+    __m128i v_fy = _mm_add_epi32(_mm_set1_epi32(fy),
+                                 _mm_set_epi32(3 * fdy, 2 * fdy, fdy, 0));
+
+    for (; length >= 4; length -= 4, buffer += 4, fx += 4 * fdx,
+                        fy += 4 * fdy) {
+        __m128i x1 = _mm_srai_epi32(v_fx, 16);
+        __m128i y1 = _mm_srai_epi32(v_fy, 16);
+        __m128i x2 = v4_clamp_sse2(_mm_add_epi32(x1, v_one), v_left, v_right);
+        __m128i y2 = v4_clamp_sse2(_mm_add_epi32(y1, v_one), v_top, v_bottom);
+        x1 = v4_clamp_sse2(x1, v_left, v_right);
+        y1 = v4_clamp_sse2(y1, v_top, v_bottom);
+
+        __m128i distx = v4_texture_weight_sse2(v_fx);
+        __m128i disty = v4_texture_weight_sse2(v_fy);
+        __m128i idistx = _mm_sub_epi16(v_full, distx);
+        __m128i idisty = _mm_sub_epi16(v_full, disty);
+
+        __m128i top = v4_interpolate_256_sse2(
+            v4_texture_fetch_sse2(tex, x1, y1), idistx,
+            v4_texture_fetch_sse2(tex, x2, y1), distx);
+        __m128i bottom = v4_interpolate_256_sse2(
+            v4_texture_fetch_sse2(tex, x1, y2), idistx,
+            v4_texture_fetch_sse2(tex, x2, y2), distx);
+
+        _mm_storeu_si128((__m128i *)buffer,
+                         v4_interpolate_256_sse2(top, idisty, bottom, disty));
+
+        v_fx = _mm_add_epi32(v_fx, v_fdx);
+        v_fy = _mm_add_epi32(v_fy, v_fdy);
+    }
+    for (int i = 0; i < length; ++i, fx += fdx, fy += fdy)
+        buffer[i] = textureBilinearPixel(tex, fx, fy);
+}
+
+// c * 255 / a through the reciprocal inv = hi << 16 | lo, c and hi are 8bits.
+static inline __m128i v4_unpremultiply_sse2(__m128i c, __m128i hi, __m128i lo)
+{
+    return _mm_add_epi32(_mm_mullo_epi16(c, hi), _mm_mulhi_epu16(c, lo));
+}
+
+static void matte_Luma_sse2(uint32_t *buffer, int length)
+{
+    const __m128i v_mask = _mm_set1_epi32(0xff);
+    const __m128i v_lo = _mm_set1_epi32(0xffff);
+    const __m128i v_zero = _mm_setzero_si128();
+    const __m128  v_red = _mm_set1_ps(0.299f);
+    const __m128  v_green = _mm_set1_ps(0.587f);
+    const __m128  v_blue = _mm_set1_ps(0.114f);
+
+    for (; length >= 4; length -= 4, buffer += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *)buffer);
+        __m128i clear = _mm_cmpeq_epi32(_mm_srli_epi32(p, 24), v_zero);
+        if (_mm_movemask_epi8(clear) == 0xffff) continue;
+
+        __m128i inv = _mm_set_epi32(int(unpremultiplyTable[buffer[3] >> 24]),
+                                    int(unpremultiplyTable[buffer[2] >> 24]),
+                                    int(unpremultiplyTable[buffer[1] >> 24]),
+                                    int(unpremultiplyTable[buffer[0] >> 24]));
+        __m128i hi = _mm_srli_epi32(inv, 16);
+        __m128i lo = _mm_and_si128(inv, v_lo);
+
+        __m128i r = v4_unpremultiply_sse2(
+            _mm_and_si128(_mm_srli_epi32(p, 16), v_mask), hi, lo);
+        __m128i g = v4_unpremultiply_sse2(
+            _mm_and_si128(_mm_srli_epi32(p, 8), v_mask), hi, lo);
+        __m128i b = v4_unpremultiply_sse2(_mm_and_si128(p, v_mask), hi, lo);
+
+        // same evaluation order as lumaPixel().
+        __m128 luma = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(v_red, _mm_cvtepi32_ps(r)),
+                       _mm_mul_ps(v_green, _mm_cvtepi32_ps(g))),
+            _mm_mul_ps(v_blue, _mm_cvtepi32_ps(b)));
+        __m128i v_luma = _mm_slli_epi32(_mm_cvttps_epi32(luma), 24);
+
+        _mm_storeu_si128((__m128i *)buffer,
+                         _mm_or_si128(_mm_and_si128(clear, p),
+                                      _mm_andnot_si128(clear, v_luma)));
+    }
+    for (int i = 0; i < length; ++i) buffer[i] = lumaPixel(buffer[i]);
+}
+
 void RenderFuncTable::sse()
 {
     updateColor(BlendMode::Src , color_Source_sse);
     updateColor(BlendMode::SrcOver , color_SourceOver_sse);
 
     updateSrc(BlendMode::Src , src_Source_sse);
+
+    updateGradient(gradient_Linear_sse2, gradient_Radial_sse2);
+    updateTexture(texture_Bilinear_sse2);
+    updateMatte(matte_Luma_sse2);
 }
 
 #endif
@@ -45,15 +45,24 @@ void VPainter::drawRle(const VRle &rle, const VRle &clip)
 
     if (!mSpanData.mUnclippedBlendFunc) return;
 
+    // the clip rle may reach outside of the area this painter covers.
+    if (!mSpanData.clipRect().contains(clip.boundingRect())) {
+        VRle regionClip = mSpanData.clipRect() & clip;
+        rle.intersect(regionClip, mSpanData.mUnclippedBlendFunc, &mSpanData);
+        return;
+    }
+
     rle.intersect(clip, mSpanData.mUnclippedBlendFunc, &mSpanData);
 }
 
 static void fillRect(const VRect &r, VSpanData *data)
 {
-    auto x1 = (std::max)(r.x(), 0);
-    auto x2 = (std::min)(r.x() + r.width(), data->mDrawableSize.width());
-    auto y1 = (std::max)(r.y(), 0);
-    auto y2 = (std::min)(r.y() + r.height(), data->mDrawableSize.height());
+    const VRect clip = data->clipRect();
+
+    auto x1 = (std::max)(r.x(), clip.left());
+    auto x2 = (std::min)(r.x() + r.width(), clip.right());
+    auto y1 = (std::max)(r.y(), clip.top());
+    auto y2 = (std::min)(r.y() + r.height(), clip.bottom());
 
     if (x2 <= x1 || y2 <= y1) return;
 
@@ -85,9 +94,10 @@ void VPainter::drawBitmapUntransform(const VRect &  target,
     mSpanData.initTexture(&bitmap, const_alpha, source);
     if (!mSpanData.mUnclippedBlendFunc) return;
 
-    // update translation matrix for source texture.
-    mSpanData.dx = float(target.x() - source.x());
-    mSpanData.dy = float(target.y() - source.y());
+    // update translation matrix for source texture, blend_image() fetches
+    // the source pixel at the target position + (dx, dy).
+    mSpanData.dx = float(source.x() - target.x());
+    mSpanData.dy = float(source.y() - target.y());
 
     fillRect(target, &mSpanData);
 }
@@ -96,19 +106,24 @@ VPainter::VPainter(VBitmap *buffer)
 {
     begin(buffer);
 }
-bool VPainter::begin(VBitmap *buffer)
+bool VPainter::begin(VBitmap *buffer, bool clear)
 {
     mBuffer.prepare(buffer);
     mSpanData.init(&mBuffer);
     // TODO find a better api to clear the surface
-    mBuffer.clear();
+    if (clear) mBuffer.clear();
     return true;
 }
 void VPainter::end() {}
 
-void VPainter::setDrawRegion(const VRect &region)
+void VPainter::setDrawRegion(const VRect &region, const VPoint &origin)
+{
+    mSpanData.setDrawRegion(region, origin);
+}
+
+void VPainter::setClipRect(const VRect &clip)
 {
-    mSpanData.setDrawRegion(region);
+    mSpanData.setClipRect(clip);
 }
 
 void VPainter::setBrush(const VBrush &brush)
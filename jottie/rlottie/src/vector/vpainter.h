@@ -35,9 +35,10 @@ class VPainter {
 public:
     VPainter() = default;
     explicit VPainter(VBitmap *buffer);
-    bool  begin(VBitmap *buffer);
+    bool  begin(VBitmap *buffer, bool clear = true);
     void  end();
-    void  setDrawRegion(const VRect &region); // sub surface rendering area.
+    void  setDrawRegion(const VRect &region, const VPoint &origin = VPoint()); // sub surface rendering area.
+    void  setClipRect(const VRect &clip); // restricts drawing inside the draw region.
     void  setBrush(const VBrush &brush);
     void  setBlendMode(BlendMode mode);
     void  drawRle(const VPoint &pos, const VRle &rle);
@@ -20,6 +20,7 @@
  * SOFTWARE.
  */
 #include "vraster.h"
+#include <chrono>
 #include <climits>
 #include <cstring>
 #include <memory>
@@ -30,6 +31,7 @@
 #include "../vector/vmatrix.h"
 #include "../vector/vpath.h"
 #include "../vector/vrle.h"
+#include "vtaskqueue.h"
 
 V_BEGIN_NAMESPACE
 
@@ -266,25 +268,116 @@ static void bboxCb(int x, int y, int w, int h, void *user)
     rle->setBoundingRect({x, y, w, h});
 }
 
+/*
+ * Completion counter shared by the rasterization requests of a frame.
+ * Waiters spin on their own result and help the scheduler, they only block
+ * on the latch once there is nothing left to run, and finishing requests
+ * take its lock only while someone is blocked.
+ */
+class VRasterLatch {
+public:
+    static VRasterLatch &shared()
+    {
+        static VRasterLatch latch;
+        return latch;
+    }
+
+    void add() { _pending.fetch_add(1, std::memory_order_relaxed); }
+
+    // the caller may be gone as soon as its result is visible, so the
+    // counter is the last thing touched here.
+    void arrive()
+    {
+        if (_waiters.load() != 0) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _cv.notify_all();
+        }
+        _pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool done() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+    template <typename Ready>
+    void wait(Ready ready)
+    {
+        while (!ready()) {
+#ifdef LOTTIE_THREAD_SUPPORT
+            // help instead of blocking, the task may still be queued
+            // while every worker is waiting on a result as well.
+            if (VTaskScheduler::instance().runPending()) continue;
+#endif
+            std::unique_lock<std::mutex> lock(_mutex);
+            _waiters.fetch_add(1);
+            // timed, tasks queued meanwhile only wake the workers.
+            if (!ready()) _cv.wait_for(lock, std::chrono::microseconds(100));
+            _waiters.fetch_sub(1);
+        }
+    }
+
+private:
+    std::atomic<size_t>     _pending{0};
+    std::atomic<unsigned>   _waiters{0};
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+};
+
+struct VRasterBatch::VRasterBatchImpl {
+    static VRasterBatchImpl *&current()
+    {
+        static thread_local VRasterBatchImpl *batch = nullptr;
+        return batch;
+    }
+
+    static VRasterLatch &currentLatch()
+    {
+        auto batch = current();
+        return batch ? batch->mLatch : VRasterLatch::shared();
+    }
+
+    static bool currentAntialiasing()
+    {
+        auto batch = current();
+        return batch ? batch->mAntialiasing : true;
+    }
+
+    // a request of the open batch is waited on before submit().
+    static void flushCurrent()
+    {
+        auto batch = current();
+        if (batch) batch->flush();
+    }
+
+    void flush()
+    {
+#ifdef LOTTIE_THREAD_SUPPORT
+        if (mTasks.empty()) return;
+        VTaskScheduler::instance().push(mTasks.data(), mTasks.size());
+        mTasks.clear();
+#endif
+    }
+
+    std::vector<VTask *> mTasks;
+    VRasterLatch         mLatch;
+    bool                 mAntialiasing{true};
+};
+
 class SharedRle {
 public:
     SharedRle() = default;
     VRle &unsafe() { return _rle; }
     void  notify()
     {
-        {
-            std::lock_guard<std::mutex> lock(_mutex);
-            _ready = true;
-        }
-        _cv.notify_one();
+        auto latch = _latch;
+        _ready.store(true);
+        latch->arrive();
     }
     void wait()
     {
         if (!_pending) return;
 
-        {
-            std::unique_lock<std::mutex> lock(_mutex);
-            while (!_ready) _cv.wait(lock);
+        if (!_ready.load(std::memory_order_acquire)) {
+            VRasterBatch::VRasterBatchImpl::flushCurrent();
+            _latch->wait([this] { return _ready.load(); });
         }
 
         _pending = false;
@@ -296,22 +389,23 @@ public:
         return _rle;
     }
 
-    void reset()
+    void reset(VRasterLatch &latch)
     {
         wait();
-        _ready = false;
+        latch.add();
+        _latch = &latch;
+        _ready.store(false, std::memory_order_relaxed);
         _pending = true;
     }
 
 private:
-    VRle                    _rle;
-    std::mutex              _mutex;
-    std::condition_variable _cv;
-    bool                    _ready{true};
-    bool                    _pending{false};
+    VRle              _rle;
+    VRasterLatch *    _latch{&VRasterLatch::shared()};
+    std::atomic<bool> _ready{true};
+    bool              _pending{false};
 };
 
-struct VRleTask {
+struct VRleTask : public VTask {
     SharedRle mRle;
     VPath     mPath;
     float     mStrokeWidth;
@@ -321,22 +415,24 @@ struct VRleTask {
     CapStyle  mCap;
     JoinStyle mJoin;
     bool      mGenerateStroke;
+    bool      mAntialiasing{true};
 
     VRle &rle() { return mRle.get(); }
 
     void update(VPath path, FillRule fillRule, const VRect &clip)
     {
-        mRle.reset();
+        mRle.reset(VRasterBatch::VRasterBatchImpl::currentLatch());
         mPath = std::move(path);
         mFillRule = fillRule;
         mClip = clip;
         mGenerateStroke = false;
+        mAntialiasing = VRasterBatch::VRasterBatchImpl::currentAntialiasing();
     }
 
     void update(VPath path, CapStyle cap, JoinStyle join, float width,
                 float miterLimit, const VRect &clip)
     {
-        mRle.reset();
+        mRle.reset(VRasterBatch::VRasterBatchImpl::currentLatch());
         mPath = std::move(path);
         mCap = cap;
         mJoin = join;
@@ -344,6 +440,7 @@ struct VRleTask {
         mMiterLimit = miterLimit;
         mClip = clip;
         mGenerateStroke = true;
+        mAntialiasing = VRasterBatch::VRasterBatchImpl::currentAntialiasing();
     }
     void render(FTOutline &outRef)
     {
@@ -351,7 +448,8 @@ struct VRleTask {
 
         mRle.unsafe().reset();
 
-        params.flags = SW_FT_RASTER_FLAG_DIRECT | SW_FT_RASTER_FLAG_AA;
+        params.flags = SW_FT_RASTER_FLAG_DIRECT;
+        if (mAntialiasing) params.flags |= SW_FT_RASTER_FLAG_AA;
         params.gray_spans = &rleGenerationCb;
         params.bbox_cb = &bboxCb;
         params.user = &mRle.unsafe();
@@ -373,6 +471,9 @@ struct VRleTask {
     {
         if (mPath.points().size() > SHRT_MAX ||
             mPath.points().size() + mPath.segments() > SHRT_MAX) {
+            mRle.unsafe().reset();
+            mPath = VPath();
+            mRle.notify();
             return;
         }
 
@@ -411,136 +512,38 @@ struct VRleTask {
 
         mRle.notify();
     }
-};
-
-using VTask = std::shared_ptr<VRleTask>;
-
-#ifdef LOTTIE_THREAD_SUPPORT
-
-#include <thread>
-#include "vtaskqueue.h"
-
-#ifdef __linux__
-#include <pthread.h>
-#include <sstream>
-#endif
-
-class RleTaskScheduler {
-    const unsigned                _count{std::thread::hardware_concurrency()};
-    std::vector<std::thread>      _threads;
-    std::vector<TaskQueue<VTask>> _q{_count};
-    std::atomic<unsigned>         _index{0};
-
-    void run(unsigned i)
-    {
-        /*
-         * initalize  per thread objects.
-         */
-        FTOutline     outlineRef;
-        SW_FT_Stroker stroker;
-        SW_FT_Stroker_New(&stroker);
-
-        // Create Thread Name for Debugging (Linux)
-#ifdef __linux__
-        std::ostringstream nameStream;
-        nameStream << "lottie-tsk-" << i;
-        pthread_setname_np(pthread_self(), nameStream.str().c_str());
-#endif
-
-        // Task Loop
-        VTask task;
-        while (true) {
-            bool success = false;
 
-            for (unsigned n = 0; n != _count * 2; ++n) {
-                if (_q[(i + n) % _count].try_pop(task)) {
-                    success = true;
-                    break;
-                }
-            }
-
-            if (!success && !_q[i].pop(task)) break;
-
-            (*task)(outlineRef, stroker);
-        }
-
-        // cleanup
-        SW_FT_Stroker_Done(stroker);
-    }
-
-    RleTaskScheduler()
-    {
-        for (unsigned n = 0; n != _count; ++n) {
-            _threads.emplace_back([&, n] { run(n); });
-        }
-
-        IsRunning = true;
-    }
-
-public:
-    static bool IsRunning;
-
-    static RleTaskScheduler &instance()
-    {
-        static RleTaskScheduler singleton;
-        return singleton;
-    }
+    void run() override;
+};
 
-    ~RleTaskScheduler() { stop(); }
+/*
+ * initalize  per thread objects.
+ */
+struct RleTaskContext {
+    RleTaskContext() { SW_FT_Stroker_New(&stroker); }
+    ~RleTaskContext() { SW_FT_Stroker_Done(stroker); }
 
-    void stop()
+    static RleTaskContext &instance()
     {
-        if (IsRunning) {
-            IsRunning = false;
-
-            for (auto &e : _q) e.done();
-            for (auto &e : _threads) e.join();
-        }
+        static vthread_local RleTaskContext context;
+        return context;
     }
 
-    void process(VTask task)
-    {
-        auto i = _index++;
-
-        for (unsigned n = 0; n != _count; ++n) {
-            if (_q[(i + n) % _count].try_push(std::move(task))) return;
-        }
-
-        if (_count > 0) {
-            _q[i % _count].push(std::move(task));
-        }
-    }
-};
-
-#else
-
-class RleTaskScheduler {
-public:
     FTOutline     outlineRef{};
     SW_FT_Stroker stroker;
-
-public:
-    static bool IsRunning;
-
-    static RleTaskScheduler &instance()
-    {
-        static RleTaskScheduler singleton;
-        return singleton;
-    }
-
-    void stop() {}
-
-    RleTaskScheduler() { SW_FT_Stroker_New(&stroker); }
-
-    ~RleTaskScheduler() { SW_FT_Stroker_Done(stroker); }
-
-    void process(VTask task) { (*task)(outlineRef, stroker); }
 };
-#endif
 
-bool RleTaskScheduler::IsRunning{false};
+void VRleTask::run()
+{
+    auto &context = RleTaskContext::instance();
+    (*this)(context.outlineRef, context.stroker);
+}
 
 struct VRasterizer::VRasterizerImpl {
+    // the scheduler only holds a pointer to the task, don't go away while
+    // it is still queued or running.
+    ~VRasterizerImpl() { mTask.mRle.wait(); }
+
     VRleTask mTask;
 
     VRle &    rle() { return mTask.rle(); }
@@ -560,8 +563,14 @@ void VRasterizer::init()
 
 void VRasterizer::updateRequest()
 {
-    VTask taskObj = VTask(d, &d->task());
-    RleTaskScheduler::instance().process(std::move(taskObj));
+#ifdef LOTTIE_THREAD_SUPPORT
+    if (auto batch = VRasterBatch::VRasterBatchImpl::current())
+        batch->mTasks.push_back(&d->task());
+    else
+        VTaskScheduler::instance().push(&d->task());
+#else
+    d->task().run();
+#endif
 }
 
 void VRasterizer::rasterize(VPath path, FillRule fillRule, const VRect &clip)
@@ -587,11 +596,36 @@ void VRasterizer::rasterize(VPath path, CapStyle cap, JoinStyle join,
     updateRequest();
 }
 
-void lottieShutdownRasterTaskScheduler()
+VRasterBatch::VRasterBatch() : d(std::make_unique<VRasterBatchImpl>()) {}
+
+VRasterBatch::~VRasterBatch()
 {
-    if (RleTaskScheduler::IsRunning) {
-        RleTaskScheduler::instance().stop();
-    }
+    // queued tasks point at the latch, it has to outlive all of them.
+    submit();
+    wait();
+}
+
+void VRasterBatch::open()
+{
+    VRasterBatchImpl::current() = d.get();
+}
+
+void VRasterBatch::submit()
+{
+    if (VRasterBatchImpl::current() == d.get())
+        VRasterBatchImpl::current() = nullptr;
+    d->flush();
+}
+
+void VRasterBatch::wait()
+{
+    auto &latch = d->mLatch;
+    latch.wait([&latch] { return latch.done(); });
+}
+
+void VRasterBatch::setAntialiasing(bool antialiasing)
+{
+    d->mAntialiasing = antialiasing;
 }
 
 V_END_NAMESPACE
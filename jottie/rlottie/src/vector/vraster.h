@@ -23,6 +23,7 @@
 #ifndef VRASTER_H
 #define VRASTER_H
 #include <future>
+#include <memory>
 #include "vglobal.h"
 #include "vrect.h"
 
@@ -45,6 +46,33 @@ private:
     std::shared_ptr<VRasterizerImpl> d{nullptr};
 };
 
+/*
+ * Collects the rasterization requests of one frame. While a batch is open
+ * every rasterize() call made on the same thread joins it instead of being
+ * scheduled on its own, submit() hands them to the scheduler in one go.
+ * The requests share a single completion counter, wait() blocks until all
+ * of them are done. The requests joining the batch are anti-aliased unless
+ * it is disabled with setAntialiasing().
+ */
+class VRasterBatch
+{
+public:
+    VRasterBatch();
+    ~VRasterBatch();
+    VRasterBatch(const VRasterBatch &) = delete;
+    VRasterBatch &operator=(const VRasterBatch &) = delete;
+
+    void open();
+    void submit();
+    void wait();
+    void setAntialiasing(bool antialiasing);
+
+    // shared with the rasterization tasks.
+    struct VRasterBatchImpl;
+private:
+    std::unique_ptr<VRasterBatchImpl> d;
+};
+
 V_END_NAMESPACE
 
 #endif  // VRASTER_H
@@ -23,65 +23,503 @@
 #ifndef VTASKQUEUE_H
 #define VTASKQUEUE_H
 
-#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../../config.h"
 
+#include <sstream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+/*
+ * Chase-Lev work stealing deque (Le, Pop, Cohen, Nardelli 2013).
+ * Only the owning worker pushes and pops at the bottom, any other worker
+ * steals from the top. Tasks are owned by the caller, the deque only moves
+ * pointers around.
+ */
 template <typename Task>
-class TaskQueue {
-    using lock_t = std::unique_lock<std::mutex>;
-    std::deque<Task>      _q;
-    bool                    _done{false};
-    std::mutex              _mutex;
-    std::condition_variable _ready;
+class WorkStealingDeque {
+    struct Array {
+        explicit Array(int64_t capacity)
+            : _capacity(capacity),
+              _mask(capacity - 1),
+              _slots(new std::atomic<Task *>[size_t(capacity)])
+        {
+        }
+
+        int64_t capacity() const { return _capacity; }
+
+        Task *get(int64_t i) const
+        {
+            return _slots[size_t(i & _mask)].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t i, Task *task)
+        {
+            _slots[size_t(i & _mask)].store(task, std::memory_order_relaxed);
+        }
+
+        Array *grow(int64_t bottom, int64_t top) const
+        {
+            auto array = new Array(_capacity * 2);
+            for (int64_t i = top; i != bottom; ++i) array->put(i, get(i));
+            return array;
+        }
+
+        int64_t                                _capacity;
+        int64_t                                _mask;
+        std::unique_ptr<std::atomic<Task *>[]> _slots;
+    };
+
+    alignas(64) std::atomic<int64_t> _top{0};
+    alignas(64) std::atomic<int64_t> _bottom{0};
+    std::atomic<Array *>             _array{new Array(256)};
+    // arrays replaced by grow() may still be read by a thief, they are
+    // released together with the deque.
+    std::vector<std::unique_ptr<Array>> _retired;
 
 public:
-    bool try_pop(Task &task)
+    WorkStealingDeque() = default;
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    ~WorkStealingDeque() { delete _array.load(std::memory_order_relaxed); }
+
+    // owner only.
+    void push(Task *task)
     {
-        lock_t lock{_mutex, std::try_to_lock};
-        if (!lock || _q.empty()) return false;
-        task = std::move(_q.front());
-        _q.pop_front();
-        return true;
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_acquire);
+        Array * a = _array.load(std::memory_order_relaxed);
+
+        if (b - t > a->capacity() - 1) {
+            _retired.emplace_back(a);
+            a = a->grow(b, t);
+            _array.store(a, std::memory_order_release);
+        }
+
+        a->put(b, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
     }
 
-    bool try_push(Task &&task)
+    // owner only.
+    Task *pop()
     {
-        {
-            lock_t lock{_mutex, std::try_to_lock};
-            if (!lock) return false;
-            _q.push_back(std::move(task));
+        int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Array * a = _array.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = _top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // empty
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Task *task = a->get(b);
+        if (t == b) {
+            // last task, race against the thieves.
+            if (!_top.compare_exchange_strong(t, t + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+                task = nullptr;
+            _bottom.store(b + 1, std::memory_order_relaxed);
         }
-        _ready.notify_one();
-        return true;
+        return task;
     }
 
-    void done()
+    // any thread.
+    Task *steal()
     {
-        {
-            lock_t lock{_mutex};
-            _done = true;
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = _bottom.load(std::memory_order_acquire);
+
+        if (t >= b) return nullptr;
+
+        Task *task = _array.load(std::memory_order_acquire)->get(t);
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;
+        return task;
+    }
+};
+
+/*
+ * Bounded lock free MPMC queue (Vyukov) for tasks submitted by threads that
+ * are not part of the scheduler and therefore own no deque.
+ */
+template <typename Task>
+class TaskInjector {
+    struct Cell {
+        std::atomic<size_t> _sequence;
+        Task *              _task;
+    };
+
+    static constexpr size_t Capacity = 4096;
+
+    std::unique_ptr<Cell[]>         _cells{new Cell[Capacity]};
+    alignas(64) std::atomic<size_t> _enqueue{0};
+    alignas(64) std::atomic<size_t> _dequeue{0};
+
+public:
+    TaskInjector()
+    {
+        for (size_t i = 0; i != Capacity; ++i)
+            _cells[i]._sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool try_push(Task *task)
+    {
+        size_t pos = _enqueue.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &   cell = _cells[pos & (Capacity - 1)];
+            size_t   seq = cell._sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (_enqueue.compare_exchange_weak(pos, pos + 1,
+                                                   std::memory_order_relaxed)) {
+                    cell._task = task;
+                    cell._sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = _enqueue.load(std::memory_order_relaxed);
+            }
         }
-        _ready.notify_all();
     }
 
-    bool pop(Task &task)
+    bool empty() const
     {
-        lock_t lock{_mutex};
-        while (_q.empty() && !_done) _ready.wait(lock);
-        if (_q.empty()) return false;
-        task = std::move(_q.front());
-        _q.pop_front();
-        return true;
+        return _dequeue.load(std::memory_order_relaxed) ==
+               _enqueue.load(std::memory_order_relaxed);
     }
 
-    void push(Task &&task)
+    Task *try_pop()
     {
-        {
-            lock_t lock{_mutex};
-            _q.push_back(std::move(task));
+        size_t pos = _dequeue.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &   cell = _cells[pos & (Capacity - 1)];
+            size_t   seq = cell._sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (_dequeue.compare_exchange_weak(pos, pos + 1,
+                                                   std::memory_order_relaxed)) {
+                    Task *task = cell._task;
+                    cell._sequence.store(pos + Capacity,
+                                         std::memory_order_release);
+                    return task;
+                }
+            } else if (diff < 0) {
+                return nullptr;  // empty
+            } else {
+                pos = _dequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+#ifndef LOTTIE_THREAD_POOL_SIZE
+#define LOTTIE_THREAD_POOL_SIZE 0
+#endif
+
+/*
+ * Unit of work run by the scheduler, owned by whoever pushes it.
+ */
+class VTask {
+public:
+    virtual ~VTask() = default;
+    virtual void run() = 0;
+};
+
+/*
+ * The single pool of workers shared by rasterization, rendering and band
+ * compositing. Each worker owns a work stealing deque, tasks pushed from
+ * any other thread go through the injector. Idle workers steal from the
+ * others and park once there is nothing left, a push unparks one of them.
+ *
+ * Instead of its own threads the pool can run on a host executor: a push
+ * then submits drain jobs to the executor, up to the configured
+ * concurrency, which run tasks until none are left.
+ *
+ * Threads waiting for a task result should help with runPending() rather
+ * than block, so that nested waits never starve the pool.
+ */
+class VTaskScheduler {
+public:
+    using Executor = std::function<void(void (*job)(void *), void *data)>;
+
+private:
+    struct alignas(64) Worker {
+        WorkStealingDeque<VTask> _deque;
+    };
+
+    struct Slot {
+        const VTaskScheduler *_scheduler{nullptr};
+        unsigned              _index{0};
+    };
+
+    static Slot &currentSlot()
+    {
+        static thread_local Slot slot;
+        return slot;
+    }
+
+    std::mutex                _configMutex;
+    unsigned                  _threadCount{LOTTIE_THREAD_POOL_SIZE};
+    Executor                  _executor;
+    unsigned                  _count{0};
+    std::atomic<bool>         _running{false};
+    std::unique_ptr<Worker[]> _workers;
+    TaskInjector<VTask>       _injector;
+    std::vector<std::thread>  _threads;
+    std::atomic<unsigned>     _draining{0};
+    std::atomic<unsigned>     _sleepers{0};
+    std::atomic<bool>         _done{false};
+    std::mutex                _mutex;
+    std::condition_variable   _wakeup;
+
+    VTaskScheduler() = default;
+
+    VTask *find(const Slot &slot)
+    {
+        unsigned i = 0;
+        if (slot._scheduler == this) {
+            i = slot._index;
+            if (auto task = _workers[i]._deque.pop()) return task;
+        }
+
+        if (auto task = _injector.try_pop()) return task;
+
+        for (unsigned n = 0; n < _count; ++n) {
+            if (auto task = _workers[(i + n) % _count]._deque.steal())
+                return task;
+        }
+        return nullptr;
+    }
+
+    void unpark(size_t count)
+    {
+        // pairs with the fence in park(), either the sleeper sees the new
+        // task or we see the sleeper.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_sleepers.load(std::memory_order_relaxed) == 0) return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (count > 1)
+            _wakeup.notify_all();
+        else
+            _wakeup.notify_one();
+    }
+
+    // blocks until a task is available, nullptr once stopped and drained.
+    VTask *park(const Slot &slot)
+    {
+        while (true) {
+            // a few rounds before parking, tasks tend to come in bursts.
+            for (unsigned n = 0; n != 16; ++n) {
+                if (auto task = find(slot)) return task;
+                std::this_thread::yield();
+            }
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            _sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (auto task = find(slot)) {
+                _sleepers.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+
+            if (_done.load()) {
+                _sleepers.fetch_sub(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            _wakeup.wait(lock);
+            _sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void setThreadName(unsigned index)
+    {
+        std::ostringstream nameStream;
+        nameStream << "lottie-wrk-" << index;
+#if defined(__APPLE__)
+        pthread_setname_np(nameStream.str().c_str());
+#elif defined(__linux__)
+        pthread_setname_np(pthread_self(), nameStream.str().c_str());
+#endif
+    }
+
+    static void drain(void *data)
+    {
+        auto scheduler = static_cast<VTaskScheduler *>(data);
+        do {
+            while (scheduler->runPending()) {
+            }
+            scheduler->releaseDrainSlot();
+            // a task pushed while we were leaving saw no free drain slot.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        } while (scheduler->_running.load() && !scheduler->_injector.empty() &&
+                 scheduler->acquireDrainSlot());
+    }
+
+    bool acquireDrainSlot()
+    {
+        unsigned draining = _draining.load();
+        while (draining < _count) {
+            if (_draining.compare_exchange_weak(draining, draining + 1))
+                return true;
+        }
+        return false;
+    }
+
+    void releaseDrainSlot()
+    {
+        // stop() resets the slots, a job still running at that point must
+        // not release twice.
+        unsigned draining = _draining.load();
+        while (draining > 0) {
+            if (_draining.compare_exchange_weak(draining, draining - 1))
+                return;
+        }
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(_configMutex);
+        if (_running.load()) return;
+
+        _done = false;
+        _draining = 0;
+        _count = _threadCount ? _threadCount
+                              : (std::max)(1u, std::thread::hardware_concurrency());
+        _workers.reset(new Worker[_count]);
+
+        if (!_executor) {
+            for (unsigned n = 0; n != _count; ++n) {
+                _threads.emplace_back([this, n] {
+                    setThreadName(n);
+                    currentSlot() = {this, n};
+                    while (auto task = park(currentSlot())) task->run();
+                });
+            }
+        }
+
+        _running = true;
+    }
+
+public:
+    static VTaskScheduler &instance()
+    {
+        static VTaskScheduler singleton;
+        return singleton;
+    }
+
+    VTaskScheduler(const VTaskScheduler &) = delete;
+    VTaskScheduler &operator=(const VTaskScheduler &) = delete;
+
+    ~VTaskScheduler() { stop(); }
+
+    /*
+     * threadCount of 0 uses one worker per hardware thread, with an executor
+     * it bounds the number of drain jobs submitted at once. A running pool
+     * is stopped and restarts with the new settings on its next use, so
+     * this must not race with rendering.
+     */
+    void configure(unsigned threadCount, Executor executor)
+    {
+        stop();
+
+        std::lock_guard<std::mutex> lock(_configMutex);
+        _threadCount = threadCount;
+        _executor = std::move(executor);
+    }
+
+    // number of threads that can work on tasks at once, the caller included.
+    size_t concurrency()
+    {
+        if (!_running.load()) start();
+        return size_t(_count) + 1;
+    }
+
+    void push(VTask *task) { push(&task, 1); }
+
+    // pushes all the tasks before waking up workers for them.
+    void push(VTask *const *tasks, size_t count)
+    {
+        if (count == 0) return;
+        if (!_running.load()) start();
+
+        const auto &slot = currentSlot();
+        for (size_t i = 0; i != count; ++i) {
+            if (slot._scheduler == this) {
+                _workers[slot._index]._deque.push(tasks[i]);
+            } else {
+                while (!_injector.try_push(tasks[i])) {
+                    if (!runPending()) std::this_thread::yield();
+                }
+            }
+        }
+
+        if (_executor) {
+            // pairs with the fence in drain(), see unpark().
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (size_t i = 0; i != count && acquireDrainSlot(); ++i)
+                _executor(&VTaskScheduler::drain, this);
+        } else {
+            unpark(count);
         }
-        _ready.notify_one();
     }
 
+    // runs one pending task on the calling thread, false if there was none.
+    bool runPending()
+    {
+        if (!_running.load()) return false;
+
+        if (auto task = find(currentSlot())) {
+            task->run();
+            return true;
+        }
+        return false;
+    }
+
+    // workers drain the pending tasks before they exit.
+    void stop()
+    {
+        std::lock_guard<std::mutex> configLock(_configMutex);
+        if (!_running.load()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _done = true;
+            _wakeup.notify_all();
+        }
+
+        for (auto &e : _threads) e.join();
+        _threads.clear();
+
+        // the host may never run the drain jobs it still holds.
+        while (runPending()) {
+        }
+
+        _running = false;
+        _draining = 0;
+    }
 };
 
 #endif  // VTASKQUEUE_H
@@ -0,0 +1,185 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#include <jottie/jottie.h>
+
+#include <vector>
+
+namespace jottie {
+namespace {
+
+//==============================================================================
+class FrameCacheTests : public juce::UnitTest
+{
+public:
+    FrameCacheTests()
+        : juce::UnitTest ("FrameCache", "jottie")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest ("Transparent frames are stored as repeat runs");
+        {
+            // a repeat run per scanline, made of its header and the pixel to repeat
+            expectRoundTrip (createImage (64, 8, {}), 8 * 2);
+        }
+
+        beginTest ("Literal runs are stored as they are");
+        {
+            // the first scanline is all literal, the others are a single repeat run
+            auto image = createImage (64, 8, {});
+            setScanline (image, 0, createDistinctPixels (64));
+
+            expectRoundTrip (image, (1 + 64) + 7 * 2);
+        }
+
+        beginTest ("Runs shorter than the minimum repeat length are literals");
+        {
+            // a b c c | d d d | e e | 0 x 23
+            const std::vector<juce::uint32> scanline { 0xff000001u, 0xff000002u, 0xff000003u, 0xff000003u,
+                                                       0xff000004u, 0xff000004u, 0xff000004u,
+                                                       0xff000005u, 0xff000005u };
+
+            auto image = createImage (32, 4, scanline);
+            expectRoundTrip (image, 4 * ((1 + 4) + 2 + (1 + 2) + 2));
+        }
+
+        beginTest ("Short runs at the end of a scanline are literals");
+        {
+            // 0 x 29 | a a a, then 0 x 30 | a a
+            auto image = createImage (32, 2, {});
+
+            auto pixels = std::vector<juce::uint32> (29, 0u);
+            pixels.insert (pixels.end(), 3, 0xff00ff00u);
+            setScanline (image, 0, pixels);
+
+            pixels = std::vector<juce::uint32> (30, 0u);
+            pixels.insert (pixels.end(), 2, 0xff00ff00u);
+            setScanline (image, 1, pixels);
+
+            expectRoundTrip (image, (2 + 2) + (2 + (1 + 2)));
+        }
+
+        beginTest ("Frames that don't compress are stored as images");
+        {
+            auto image = createImage (64, 8, {});
+            for (int y = 0; y < image.getHeight(); ++y)
+                setScanline (image, y, createDistinctPixels (64, static_cast<juce::uint32> (y * 64)));
+
+            LottieFrameCache cache (1 << 20, LottieFrameCache::Compression::RunLength);
+            cache.addFrame (createKey (image), image);
+
+            expectEquals (static_cast<int> (cache.getCurrentSize()), 64 * 8 * 4);
+
+            juce::Image cachedImage;
+            expect (cache.getFrame (createKey (image), cachedImage));
+            expect (cachedImage == image);
+        }
+    }
+
+private:
+    static juce::Image createImage (int width, int height, const std::vector<juce::uint32>& scanlineStart)
+    {
+        juce::Image image (juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+
+        for (int y = 0; y < height; ++y)
+            setScanline (image, y, scanlineStart);
+
+        return image;
+    }
+
+    static void setScanline (juce::Image& image, int y, const std::vector<juce::uint32>& pixels)
+    {
+        const juce::Image::BitmapData bitmapData (image, juce::Image::BitmapData::readWrite);
+        auto* line = reinterpret_cast<juce::uint32*> (bitmapData.getLinePointer (y));
+
+        for (std::size_t x = 0; x < pixels.size(); ++x)
+            line[x] = pixels[x];
+    }
+
+    static std::vector<juce::uint32> createDistinctPixels (int numPixels, juce::uint32 firstPixel = 0)
+    {
+        std::vector<juce::uint32> pixels;
+
+        for (int i = 0; i < numPixels; ++i)
+            pixels.push_back (0xff000000u | (firstPixel + static_cast<juce::uint32> (i) + 1u));
+
+        return pixels;
+    }
+
+    static LottieFrameCache::Key createKey (const juce::Image& image)
+    {
+        return { "test", 0, image.getWidth(), image.getHeight(), true };
+    }
+
+    static bool haveSamePixels (const juce::Image& a, const juce::Image& b)
+    {
+        const juce::Image::BitmapData dataA (a, juce::Image::BitmapData::readOnly);
+        const juce::Image::BitmapData dataB (b, juce::Image::BitmapData::readOnly);
+
+        for (int y = 0; y < a.getHeight(); ++y)
+        {
+            const auto* lineA = reinterpret_cast<const juce::uint32*> (dataA.getLinePointer (y));
+            const auto* lineB = reinterpret_cast<const juce::uint32*> (dataB.getLinePointer (y));
+
+            for (int x = 0; x < a.getWidth(); ++x)
+                if (lineA[x] != lineB[x])
+                    return false;
+        }
+
+        return true;
+    }
+
+    void expectRoundTrip (const juce::Image& image, int expectedEncodedWords)
+    {
+        LottieFrameCache cache (1 << 20, LottieFrameCache::Compression::RunLength);
+        cache.addFrame (createKey (image), image);
+
+        expectEquals (static_cast<int> (cache.getCurrentSize()), expectedEncodedWords * 4);
+
+        // decoded into a new image, then into the same image again over different content
+        juce::Image decodedImage;
+        expect (cache.getFrame (createKey (image), decodedImage));
+        expect (decodedImage != image);
+        expect (haveSamePixels (decodedImage, image));
+
+        decodedImage.clear (decodedImage.getBounds(), juce::Colours::red);
+        expect (cache.getFrame (createKey (image), decodedImage));
+        expect (haveSamePixels (decodedImage, image));
+    }
+};
+
+static FrameCacheTests frameCacheTests;
+
+} // namespace
+} // namespace jottie
@@ -0,0 +1,199 @@
+/**
+ * ==============================================================================
+ *
+ * This file is part of the `jottie` library.
+ *
+ * Standalone JUCE module https://github.com/kunitoki/jottie
+ * Copyright (c) 2023 Lucio Asnaghi
+ *
+ * Originally created in HISE https://github.com/christophhart/HISE/tree/master/hi_rlottie
+ * Copyright (c) 2019 Christoph Hart
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * ==============================================================================
+ */
+
+#include <jottie/jottie.h>
+
+#include <vector>
+
+namespace jottie {
+namespace {
+
+//==============================================================================
+struct RenderedFrame
+{
+    RenderedFrame (int w, int h)
+        : width (w)
+        , height (h)
+        , pixels (static_cast<std::size_t> (w * h), 0u)
+    {
+    }
+
+    int countDifferences (const RenderedFrame& other, juce::Rectangle<int> area) const
+    {
+        int numDifferences = 0;
+
+        for (int y = area.getY(); y < area.getBottom(); ++y)
+            for (int x = area.getX(); x < area.getRight(); ++x)
+                numDifferences += getPixel (x, y) != other.getPixel (x, y) ? 1 : 0;
+
+        return numDifferences;
+    }
+
+    uint32_t getPixel (int x, int y) const
+    {
+        return pixels[static_cast<std::size_t> (y * width + x)];
+    }
+
+    uint32_t* getData() { return pixels.data(); }
+    std::size_t getBytesPerLine() const { return static_cast<std::size_t> (width) * sizeof (uint32_t); }
+
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+};
+
+//==============================================================================
+class RenderTests : public juce::UnitTest
+{
+public:
+    RenderTests()
+        : juce::UnitTest ("Render", "jottie")
+    {
+    }
+
+    void runTest() override
+    {
+        juce::StringArray animationNames;
+        juce::StringArray animationData;
+
+        for (const auto& file : juce::File (JOTTIE_TESTS_ASSETS_PATH).findChildFiles (juce::File::findFiles, false, "*.json"))
+        {
+            animationNames.add (file.getFileName());
+            animationData.add (file.loadFileAsString());
+        }
+
+        juce::ZipFile exampleFile (juce::File (JOTTIE_EXAMPLE_ASSETS_PATH).getChildFile ("cook.lottie"));
+        for (int i = 0; i < exampleFile.getNumEntries(); ++i)
+        {
+            const auto* entry = exampleFile.getEntry (i);
+            if (! entry->filename.startsWith ("animations/") || ! entry->filename.endsWith (".json"))
+                continue;
+
+            std::unique_ptr<juce::InputStream> stream (exampleFile.createStreamForEntry (i));
+            if (stream == nullptr)
+                continue;
+
+            animationNames.add (entry->filename);
+            animationData.add (stream->readEntireStreamAsString());
+        }
+
+        expect (animationNames.size() > 2);
+
+        for (int i = 0; i < animationNames.size(); ++i)
+        {
+            beginTest ("Incremental renders match full renders: " + animationNames[i]);
+            expectIncrementalRendersMatch (animationData[i]);
+
+            beginTest ("Clipped renders match full renders: " + animationNames[i]);
+            expectClippedRendersMatch (animationData[i]);
+        }
+    }
+
+private:
+    // odd sizes, so the animations are scaled by a non integer factor
+    static constexpr int width = 517;
+    static constexpr int height = 403;
+
+    void expectIncrementalRendersMatch (const juce::String& data)
+    {
+        auto model = lottie_model_from_data (data.toRawUTF8(), "");
+        expect (model != nullptr);
+        if (model == nullptr)
+            return;
+
+        auto fullAnimation = lottie_animation_from_model (model);
+        auto incrementalAnimation = lottie_animation_from_model (model);
+
+        RenderedFrame incrementalFrame (width, height);
+        const auto numFrames = lottie_animation_get_totalframe (fullAnimation);
+
+        for (std::size_t frameNumber = 0; frameNumber < numFrames; ++frameNumber)
+        {
+            RenderedFrame fullFrame (width, height);
+            lottie_animation_render (fullAnimation, frameNumber, fullFrame.getData(),
+                                     width, height, fullFrame.getBytesPerLine());
+
+            // the buffer holds the previous frame, so only the damaged area is redrawn
+            lottie_animation_render_incremental (incrementalAnimation, frameNumber, incrementalFrame.getData(),
+                                                 width, height, incrementalFrame.getBytesPerLine());
+
+            expectEquals (incrementalFrame.countDifferences (fullFrame, { width, height }), 0,
+                          "frame " + juce::String (static_cast<int> (frameNumber)));
+        }
+
+        lottie_animation_destroy (fullAnimation);
+        lottie_animation_destroy (incrementalAnimation);
+        lottie_model_destroy (model);
+    }
+
+    void expectClippedRendersMatch (const juce::String& data)
+    {
+        auto model = lottie_model_from_data (data.toRawUTF8(), "");
+        expect (model != nullptr);
+        if (model == nullptr)
+            return;
+
+        auto fullAnimation = lottie_animation_from_model (model);
+        auto clippedAnimation = lottie_animation_from_model (model);
+
+        const juce::Rectangle<int> clip (width / 5, height / 3, width / 2 + 1, height / 3 + 1);
+        const auto numFrames = lottie_animation_get_totalframe (fullAnimation);
+
+        for (std::size_t frameNumber = 0; frameNumber < numFrames; ++frameNumber)
+        {
+            RenderedFrame fullFrame (width, height);
+            lottie_animation_render (fullAnimation, frameNumber, fullFrame.getData(),
+                                     width, height, fullFrame.getBytesPerLine());
+
+            RenderedFrame clippedFrame (width, height);
+            lottie_animation_render_clipped (clippedAnimation, frameNumber, clippedFrame.getData(),
+                                             width, height, clippedFrame.getBytesPerLine(),
+                                             static_cast<std::size_t> (clip.getX()),
+                                             static_cast<std::size_t> (clip.getY()),
+                                             static_cast<std::size_t> (clip.getWidth()),
+                                             static_cast<std::size_t> (clip.getHeight()),
+                                             0);
+
+            expectEquals (clippedFrame.countDifferences (fullFrame, clip), 0,
+                          "frame " + juce::String (static_cast<int> (frameNumber)));
+        }
+
+        lottie_animation_destroy (fullAnimation);
+        lottie_animation_destroy (clippedAnimation);
+        lottie_model_destroy (model);
+    }
+};
+
+static RenderTests renderTests;
+
+} // namespace
+} // namespace jottie